@@ -0,0 +1,190 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*****************************************************************************/
+
+#include <algorithm>
+#include <vector>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "acquisition.h"
+
+/*****************************************************************************/
+
+Acquisition::Acquisition(BITalino &dev) : dev(dev), received(0), highWater(0), overflows(0), error(0)
+{
+   event = eventfd(0, EFD_NONBLOCK);
+   stopEvent = eventfd(0, EFD_NONBLOCK);
+   if (event < 0 || stopEvent < 0)
+   {
+      if (event >= 0)      ::close(event);
+      if (stopEvent >= 0)  ::close(stopEvent);
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+   }
+
+   thread = std::thread(&Acquisition::run, this);
+}
+
+/*****************************************************************************/
+
+Acquisition::~Acquisition()
+{
+   stop();
+
+   ::close(event);
+   ::close(stopEvent);
+}
+
+/*****************************************************************************/
+
+void Acquisition::stop(void)
+{
+   if (!thread.joinable())   return;
+
+   signal(stopEvent);
+   thread.join();
+}
+
+/*****************************************************************************/
+
+int Acquisition::read(BITalino::FrameBatch &frames, std::chrono::steady_clock::time_point *received)
+{
+   if (frames.empty())   frames.resize(100);
+
+   // reset the event before looking at the ring, so that frames pushed from now on signal it again
+   uint64_t count;
+   if (::read(event, &count, sizeof count)) {}
+
+   // an error is raised only after the frames received before it are consumed
+   const int code = error.load(std::memory_order_acquire);
+
+   // transpose straight from the ring memory, then release the frames to the acquisition thread
+   const Circular_Spans<Stamped> view = ring.spans();
+   const int n = (int) std::min(frames.size(), (size_t) view.size());
+   if (n == 0)
+   {
+      if (code != 0)   throw BITalino::Exception(BITalino::Exception::Code(code));
+      return 0;
+   }
+
+   for(int i = 0; i < n; i++)
+   {
+      const BITalino::Frame &f = ((i < view.first_length) ? view.first[i] : view.second[i - view.first_length]).frame;
+      frames.seq[i] = f.seq;
+      frames.digital[i] = f.digital[0] | (f.digital[1] << 1) | (f.digital[2] << 2) | (f.digital[3] << 3);
+      for(int k = 0; k < 6; k++)
+         frames.analog[k][i] = f.analog[k];
+   }
+
+   if (received)
+      *received = ((n - 1 < view.first_length) ? view.first[n - 1] : view.second[n - 1 - view.first_length]).time;
+
+   ring.consume((uint16_t) n);
+   return n;
+}
+
+/*****************************************************************************/
+
+Acquisition::Stats Acquisition::stats(void) const
+{
+   Stats st;
+   st.highWater = highWater.load(std::memory_order_relaxed);
+   st.overflows = overflows.load(std::memory_order_relaxed);
+   st.frames = received.load(std::memory_order_relaxed);
+   return st;
+}
+
+/*****************************************************************************/
+
+void Acquisition::run(void)
+{
+   BITalino::VFrame frames(100);
+   std::vector<Stamped> stamped(frames.size());
+
+   pollfd fds[2];
+   fds[0].fd = dev.fileDescriptor();
+   fds[0].events = POLLIN;
+   fds[1].fd = stopEvent;
+   fds[1].events = POLLIN;
+
+   try
+   {
+      while (1)
+      {
+         // no data from the device for 5 seconds means the connection is lost
+         const int state = poll(fds, 2, 5000);
+         if (state == 0)   throw BITalino::Exception(BITalino::Exception::CONTACTING_DEVICE);
+         if (state < 0)    continue;    // interrupted by a signal
+
+         if (fds[1].revents)   return;
+
+         // frames may remain in the staging buffer after the descriptor has been drained
+         int nFrames;
+         do
+         {
+            nFrames = dev.readAvailable(frames);
+            if (nFrames <= 0)   continue;
+
+            // the frames of a read were all received by now
+            const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            for(int i = 0; i < nFrames; i++)
+            {
+               stamped[i].frame = frames[i];
+               stamped[i].time = now;
+            }
+            if (push(&stamped[0], nFrames) > 0)
+               signal(event);
+         } while (nFrames == (int) frames.size());
+      }
+   }
+   catch (BITalino::Exception &e)
+   {
+      error.store(e.code, std::memory_order_release);
+      signal(event);
+   }
+}
+
+/*****************************************************************************/
+
+int Acquisition::push(const Stamped *frames, int nFrames)
+{
+   const int n = ring.write(frames, (uint16_t) nFrames);
+
+   received.fetch_add(nFrames, std::memory_order_relaxed);
+   overflows.fetch_add(nFrames - n, std::memory_order_relaxed);
+
+   const int used = ring.size();
+   if (used > highWater.load(std::memory_order_relaxed))
+      highWater.store(used, std::memory_order_relaxed);
+
+   return n;
+}
+
+/*****************************************************************************/
+
+void Acquisition::signal(int fd)
+{
+   const uint64_t one = 1;
+   if (::write(fd, &one, sizeof one)) {}
+}
+
+/*****************************************************************************/
@@ -0,0 +1,102 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Per-sample step() + getValue() against the block step(in, out, n), in ns per sample, with blocks of 10
+// (a 100 Hz batch per 100 ms poll) and of 100 (a 1000 Hz batch). Before timing, the block and in-place
+// outputs are compared to the per-sample output, which they must match exactly.
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "BiquadFilter.h"
+#include "ButterworthFilter.h"
+#include "SimpleFilter.h"
+
+template<class F, class T>
+static double bench(F filter, const std::vector<T> &x, size_t block, bool perSample, std::vector<T> &y)
+{
+    const int repeats = 100;
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++)
+        for (size_t i = 0; i < x.size(); i += block)
+        {
+            const size_t n = std::min(block, x.size() - i);
+            if (perSample)
+                for (size_t j = 0; j < n; j++)
+                {
+                    filter.step(x[i+j]);
+                    y[i+j] = filter.getValue();
+                }
+            else
+                filter.step(&x[i], &y[i], n);
+        }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (repeats * x.size());
+}
+
+template<class F, class T>
+static void run(const char *name, const F &design, const std::vector<T> &x)
+{
+    std::vector<T> single(x.size()), block(x.size()), inPlace(x);
+
+    F f1 = design, f2 = design, f3 = design;
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        f1.step(x[i]);
+        single[i] = f1.getValue();
+    }
+    for (size_t i = 0; i < x.size(); i += 37)
+        f2.step(&x[i], &block[i], std::min<size_t>(37, x.size() - i));
+    for (size_t i = 0; i < x.size(); i += 10)
+        f3.step(&inPlace[i], std::min<size_t>(10, x.size() - i));
+    size_t differences = 0;
+    for (size_t i = 0; i < x.size(); i++)
+        differences += (single[i] != block[i]) + (single[i] != inPlace[i]);
+
+    printf("%-28s per-sample %6.2f ns, block 10 %6.2f ns, block 100 %6.2f ns%s\n", name,
+           bench(design, x, 100, true, block), bench(design, x, 10, false, block), bench(design, x, 100, false, block),
+           differences ? ", OUTPUTS DIFFER" : "");
+}
+
+int main()
+{
+    srand(1);
+    std::vector<long> xl(200000);
+    std::vector<double> xd(xl.size());
+    std::vector<float> xf(xl.size());
+    for (size_t i = 0; i < xl.size(); i++)
+    {
+        xl[i] = 512 + rand() % 300;
+        xd[i] = xl[i];
+        xf[i] = xl[i];
+    }
+
+    run("ButterworthFilter<long>", ButterworthFilter<long>(100, 20), xl);
+    run("ButterworthFilter<double>", ButterworthFilter<double>(100, 20), xd);
+    run("HighPassFilter<long>", HighPassFilter<long>(100, 1), xl);
+    run("HighPassFilter<double>", HighPassFilter<double>(100, 1), xd);
+    run("LowPassFilter<double>", LowPassFilter<double>(100, 5), xd);
+    run("BiquadCascade<double> BP2", BiquadCascade<double>(BiquadCascade<double>::BandPass, 100, 1, 20, 2), xd);
+    run("BiquadCascade<float> BP2", BiquadCascade<float>(BiquadCascade<float>::BandPass, 100, 1, 20, 2), xf);
+    run("BiquadCascade<double> LP8", BiquadCascade<double>(BiquadCascade<double>::LowPass, 1000, 40, 8), xd);
+    return 0;
+}
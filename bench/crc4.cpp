@@ -0,0 +1,86 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// CRC4 check of frames: checkCRC4() one frame at a time against checkCRC4Frames() on a batch,
+// at the frame sizes of 1, 3 and 6 analog channels (3, 6 and 8 bytes).
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "crc4.h"
+
+template<int len>
+static void bench(int nChannels)
+{
+    const int nFrames = 4096;
+    const int repeats = 2000;
+
+    // valid frames: random bytes, with the CRC nibble which makes each frame pass
+    std::vector<unsigned char> data(nFrames * len);
+    for (size_t i = 0; i < data.size(); i++)    data[i] = (unsigned char) rand();
+    for (int f = 0; f < nFrames; f++)
+    {
+        unsigned char *frame = &data[f * len];
+        for (int crc = 0; crc < 16; crc++)
+        {
+            frame[len-1] = (frame[len-1] & 0xF0) | crc;
+            if (checkCRC4(frame, len))    break;
+        }
+    }
+
+    // both functions must agree on every frame, valid or corrupted
+    int mismatches = 0;
+    std::vector<unsigned char> corrupted(data);
+    for (int f = 0; f < nFrames; f++)
+    {
+        unsigned char *frame = &corrupted[f * len];
+        frame[rand() % len] ^= (unsigned char) (1 << (rand() % 8));
+        if (checkCRC4(frame, len) != (checkCRC4Frames<len>(frame, 1) == 1))    mismatches++;
+    }
+
+    volatile int sink = 0;
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++)
+    {
+        int n = 0;
+        while (n < nFrames && checkCRC4(&data[n * len], len))    n++;
+        sink += n;
+    }
+    const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++)
+        sink += checkCRC4Frames<len>(&data[0], nFrames);
+    const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+    const double single = std::chrono::duration<double, std::nano>(t1 - t0).count() / (repeats * nFrames);
+    const double batch = std::chrono::duration<double, std::nano>(t2 - t1).count() / (repeats * nFrames);
+    printf("%d channel(s), %d-byte frames: checkCRC4 %.2f ns/frame, checkCRC4Frames %.2f ns/frame (x%.1f), %d mismatches\n",
+           nChannels, len, single, batch, single / batch, mismatches);
+}
+
+int main()
+{
+    srand(3);
+    bench<3>(1);
+    bench<6>(3);
+    bench<8>(6);
+    return 0;
+}
@@ -0,0 +1,75 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Cost of push_back() + max() + min() per sample on a full Circular_Buffer, with the sorting fallback
+// and with the Windowed_Extremum policy, for windows of 32 to 4096 values.
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "circular_buffer.h"
+
+template<uint16_t N>
+static void bench()
+{
+    static Circular_Buffer<long, N> sorted;
+    static Circular_Buffer<long, N, 0, Windowed_Extremum> policy;
+    const int n = (N >= 1024) ? 20000 : 200000;
+
+    srand(1);
+    for (int i = 0; i < N; i++)
+    {
+        const long value = rand() % 100000;
+        sorted.push_back(value);
+        policy.push_back(value);
+    }
+
+    long sum1 = 0, sum2 = 0;
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    srand(2);
+    for (int i = 0; i < n; i++)
+    {
+        sorted.push_back(rand() % 100000);
+        sum1 += sorted.max() + sorted.min();
+    }
+    const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    srand(2);
+    for (int i = 0; i < n; i++)
+    {
+        policy.push_back(rand() % 100000);
+        sum2 += policy.max() + policy.min();
+    }
+    const std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+    const double ns1 = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+    const double ns2 = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+    printf("window %5u: sort %10.0f ns/sample, policy %6.1f ns/sample (x%.0f)%s\n",
+           N, ns1, ns2, ns1 / ns2, sum1 == sum2 ? "" : ", RESULTS DIFFER");
+}
+
+int main()
+{
+    bench<32>();
+    bench<256>();
+    bench<1024>();
+    bench<4096>();
+    return 0;
+}
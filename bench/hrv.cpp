@@ -0,0 +1,107 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// CPU cost of HRVAnalyzer as main uses it (60 beats, 120 s spectral window, spectrum at most every 5 s):
+// every beat is added with update() and all six metrics are read. 2000 synthetic RR intervals (0.85 s mean,
+// 40 ms at 0.1 Hz, 30 ms at 0.25 Hz, +-5 ms jitter) are processed, and the CPU time is given per beat, per
+// spectrum, and as a share of one core over the duration of the beats. Meant to be run on the target
+// (for instance a Raspberry Pi).
+
+#include <chrono>
+#include <ctime>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "HRVAnalyzer.h"
+
+static const double pi = 3.14159265358979323846;
+static volatile double sink;
+
+// RR intervals (s) and beat times (s)
+static void intervals(int beats, std::vector<double> &rr, std::vector<double> &times)
+{
+    srand(3);
+    double t = 1000;
+    for (int b = 0; b < beats; b++)
+    {
+        const double r = 0.85 + 0.040 * sin(2 * pi * 0.1 * t) + 0.030 * sin(2 * pi * 0.25 * t) + 0.005 * ((rand() % 2001) / 1000.0 - 1);
+        t += r;
+        rr.push_back(r);
+        times.push_back(t);
+    }
+}
+
+// CPU seconds to process the beats as main does
+static double run(const std::vector<double> &rr, const std::vector<double> &times, double metrics[6])
+{
+    HRVAnalyzer hrv(60, 120, 5);
+    const std::clock_t c0 = std::clock();
+    for (size_t b = 0; b < rr.size(); b++)
+    {
+        hrv.update(rr[b], times[b]);
+        metrics[0] += hrv.getRMSSD();
+        metrics[1] += hrv.getSDNN();
+        metrics[2] += hrv.getPNN50();
+        metrics[3] += hrv.getLF();
+        metrics[4] += hrv.getHF();
+        metrics[5] += hrv.getLFHF();
+    }
+    return double(std::clock() - c0) / CLOCKS_PER_SEC;
+}
+
+int main()
+{
+    std::vector<double> rr, times;
+    intervals(2000, rr, times);
+    const double duration = times.back() - times.front();
+    double metrics[6] = {0, 0, 0, 0, 0, 0};
+
+    // update() and the time-domain metrics only
+    HRVAnalyzer timeDomain(60, 120, 5);
+    const std::clock_t c0 = std::clock();
+    for (size_t b = 0; b < rr.size(); b++)
+    {
+        timeDomain.update(rr[b], times[b]);
+        metrics[0] += timeDomain.getRMSSD() + timeDomain.getSDNN() + timeDomain.getPNN50();
+    }
+    const double perBeat = double(std::clock() - c0) / CLOCKS_PER_SEC / rr.size();
+
+    // spectrum recomputed with every beat, once the spectral window is full
+    HRVAnalyzer spectral(60, 120, 0);
+    for (size_t b = 0; b < 200; b++)
+        spectral.update(rr[b], times[b]);
+    const std::clock_t c1 = std::clock();
+    for (size_t b = 200; b < rr.size(); b++)
+    {
+        spectral.update(rr[b], times[b]);
+        metrics[3] += spectral.getLF();
+    }
+    const double spectrum = double(std::clock() - c1) / CLOCKS_PER_SEC / (rr.size() - 200);
+
+    const double bridge = run(rr, times, metrics);
+
+    sink = metrics[0] + metrics[3];
+    printf("update() and time-domain metrics: %.3f us per beat\n", perBeat * 1e6);
+    printf("spectrum: %.0f us\n", spectrum * 1e6);
+    printf("as in the bridge: %.3f s of CPU for %.0f s of beats, %.4f%% of a core\n", bridge, duration, 100 * bridge / duration);
+    return 0;
+}
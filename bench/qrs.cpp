@@ -0,0 +1,85 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Cost of QRSDetector::update() per sample, on a 300 s synthetic ECG band-passed at 1-20 Hz, at 100 Hz
+// (the bridge's rate) and at 1000 Hz, at 60 and 180 BPM.
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "BiquadFilter.h"
+#include "QRSDetector.h"
+
+static const double pi = 3.14159265358979323846;
+
+static double gauss(double t, double mu, double sigma) { return exp(-(t - mu) * (t - mu) / (2 * sigma * sigma)); }
+
+// ECG in ADC counts with RR variability, baseline wander and noise
+static void ecg(double fs, double length, double bpm, std::vector<double> &x)
+{
+    srand(11);
+    std::vector<double> beats;
+    for (double t = 0.4; t < length; t += 60 / bpm * (1 + 0.08 * ((rand() % 200) / 100.0 - 1)))
+        beats.push_back(t);
+
+    x.assign((size_t) (fs * length), 0);
+    size_t first = 0;
+    for (size_t k = 0; k < x.size(); k++)
+    {
+        const double t = k / fs;
+        double e = 0;
+        while (first < beats.size() && beats[first] < t - 0.6)    first++;
+        for (size_t b = first; b < beats.size() && beats[b] < t + 0.6; b++)
+        {
+            const double tb = t - beats[b];
+            e += 0.12 * gauss(tb, -0.2, 0.025) - 0.1 * gauss(tb, -0.03, 0.01) + gauss(tb, 0, 0.012)
+                 - 0.25 * gauss(tb, 0.03, 0.01) + 0.35 * gauss(tb, 0.25, 0.04);
+        }
+        x[k] = 512 + 300 * e + 40 * sin(2 * pi * 0.25 * t) + 5 * ((rand() % 2001) / 1000.0 - 1);
+    }
+}
+
+static void bench(double fs, double bpm)
+{
+    std::vector<double> x;
+    ecg(fs, 300, bpm, x);
+    BiquadCascade<double> bandpass(BiquadCascade<double>::BandPass, fs, 1, 20, 2);
+    bandpass.step(&x[0], x.size());
+
+    QRSDetector detector(fs);
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < x.size(); i++)
+        detector.update(x[i]);
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / x.size();
+
+    printf("%4.0f Hz, %3.0f BPM: %6.1f ns/sample, %u beats detected in 300 s\n", fs, bpm, ns, detector.getBeats());
+}
+
+int main()
+{
+    bench(100, 60);
+    bench(100, 180);
+    bench(1000, 60);
+    bench(1000, 180);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Two-thread throughput of Circular_Buffer_SPSC (4096 x uint64_t), against a mutex-protected std::deque
+// of the same capacity, with chunks of 1, 16 and 256 values. Both sides yield when the ring is full or empty.
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+
+#include "circular_buffer.h"
+
+template<int chunk>
+static void spsc(uint64_t total)
+{
+    static Circular_Buffer_SPSC<uint64_t, 4096> ring;
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    std::thread producer([&]
+    {
+        uint64_t buffer[chunk];
+        uint64_t next = 0;
+        while (next < total)
+        {
+            for (int i = 0; i < chunk; i++)    buffer[i] = next + i;
+            const int written = ring.write(buffer, chunk);
+            if (!written)    std::this_thread::yield();
+            next += written;
+        }
+    });
+
+    uint64_t buffer[chunk];
+    uint64_t received = 0, sum = 0;
+    while (received < total)
+    {
+        const int n = ring.read(buffer, chunk);
+        if (!n)    std::this_thread::yield();
+        for (int i = 0; i < n; i++)    sum += buffer[i];
+        received += n;
+    }
+    producer.join();
+
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("SPSC ring,   chunks of %3d: %7.1f M values/s (checksum %llu)\n", chunk, total / s / 1e6, (unsigned long long) (sum & 0xFF));
+}
+
+template<int chunk>
+static void mutex(uint64_t total)
+{
+    std::mutex lock;
+    std::deque<uint64_t> queue;
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    std::thread producer([&]
+    {
+        uint64_t next = 0;
+        while (next < total)
+        {
+            bool full;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                full = queue.size() >= 4096;
+                if (!full)
+                    for (int i = 0; i < chunk && next < total; i++)    queue.push_back(next++);
+            }
+            if (full)    std::this_thread::yield();
+        }
+    });
+
+    uint64_t received = 0, sum = 0;
+    while (received < total)
+    {
+        int n = 0;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (; n < chunk && !queue.empty(); n++)
+            {
+                sum += queue.front();
+                queue.pop_front();
+            }
+        }
+        if (!n)    std::this_thread::yield();
+        received += n;
+    }
+    producer.join();
+
+    const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("mutex+deque, chunks of %3d: %7.1f M values/s (checksum %llu)\n", chunk, total / s / 1e6, (unsigned long long) (sum & 0xFF));
+}
+
+int main()
+{
+    spsc<1>(20000000);
+    mutex<1>(20000000);
+    spsc<16>(100000000);
+    mutex<16>(100000000);
+    spsc<256>(200000000);
+    mutex<256>(200000000);
+    return 0;
+}
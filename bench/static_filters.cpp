@@ -0,0 +1,85 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Run-time filters against their Static* variants, whose coefficients are compile-time constants:
+// largest output difference, and ns per sample with per-sample and block step().
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "ButterworthFilter.h"
+#include "SimpleFilter.h"
+
+// read at run time, so that the optimizer cannot fold the coefficients of the run-time filters
+static volatile double rate100 = 100, rate1000 = 1000;
+static volatile double sink;
+
+template<class F, typename T>
+static double bench(F &filter, const std::vector<T> &x, bool block)
+{
+    const int repeats = 100;
+    std::vector<T> y(x.size());
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++)
+    {
+        if (block)
+            filter.step(&x[0], &y[0], x.size());
+        else
+            for (size_t i = 0; i < x.size(); i++)    y[i] = filter.step(x[i]);
+    }
+    const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    sink = (double) y[7];
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (repeats * x.size());
+}
+
+template<class R, class S, typename T>
+static void compare(const char *name, R runtime, S fixed, const std::vector<T> &x)
+{
+    double difference = 0;
+    for (size_t i = 0; i < 10000; i++)
+        difference = std::max(difference, fabs((double) runtime.step(x[i]) - (double) fixed.step(x[i])));
+    const double r1 = bench(runtime, x, false), s1 = bench(fixed, x, false);
+    const double r2 = bench(runtime, x, true), s2 = bench(fixed, x, true);
+    printf("%-34s max difference %.3g; per-sample: run-time %5.2f ns, static %5.2f ns; block: run-time %5.2f ns, static %5.2f ns\n",
+           name, difference, r1, s1, r2, s2);
+}
+
+int main()
+{
+    srand(1);
+    std::vector<long> xl(100000);
+    std::vector<double> xd(xl.size());
+    for (size_t i = 0; i < xl.size(); i++)
+    {
+        xl[i] = 512 + rand() % 300;
+        xd[i] = xl[i];
+    }
+
+    compare("Butterworth 20 Hz @100, double", ButterworthFilter<double>(rate100, 20), StaticButterworthFilter<double, 100, 20>(), xd);
+    compare("Butterworth 20 Hz @100, long", ButterworthFilter<long>(rate100, 20), StaticButterworthFilter<long, 100, 20>(), xl);
+    compare("HighPass 1 Hz @100, double", HighPassFilter<double>(rate100, 1), StaticHighPassFilter<double, 100, 1>(), xd);
+    compare("HighPass 0.5 Hz @1000, double", HighPassFilter<double>(rate1000, 0.5), StaticHighPassFilter<double, 1000, 1, 2>(), xd);
+    compare("LowPass 8 Hz @100, double", LowPassFilter<double>(rate100, 8), StaticLowPassFilter<double, 100, 8>(), xd);
+    return 0;
+}
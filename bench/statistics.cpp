@@ -0,0 +1,142 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Cost of the statistics of a full, wrapped Circular_Buffer without policies: max(), min(), median() and
+// sort_descending(), against the copy-and-sort way they used to work (the window copied to a stack
+// array and sorted on every call), for windows of 32 to 4096 values. Results are compared to the baseline.
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "circular_buffer.h"
+
+static volatile long sink;
+
+// copy of the window sorted ascending, as the statistics used to compute it
+template<typename T, uint16_t N>
+static void sortedCopy(Circular_Buffer<T, N> &buffer, std::vector<T> &copy)
+{
+    copy.resize(buffer.size());
+    for (int i = 0; i < buffer.size(); i++)    copy[i] = buffer.peek(i);
+    std::sort(copy.begin(), copy.end());
+}
+
+static double ns(std::chrono::steady_clock::time_point t0, std::chrono::steady_clock::time_point t1, int n)
+{
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+template<uint16_t N>
+static void bench()
+{
+    static Circular_Buffer<long, N> buffer;
+    std::vector<long> copy;
+    copy.reserve(N);
+    const int repeats = 2000000 / N;
+    long sum1 = 0, sum2 = 0;
+    int errors = 0;
+
+    srand(1);
+    for (int i = 0; i < N + N / 3; i++)    buffer.push_back(rand() % 100000);
+
+    // baseline: max, min and median from a sorted copy, and a descending sort copied back
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    srand(2);
+    for (int r = 0; r < repeats; r++)
+    {
+        buffer.push_back(rand() % 100000);
+        sortedCopy(buffer, copy);
+        sum1 += copy.back() + copy.front() + copy[N / 2];
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats / 4 + 1; r++)
+    {
+        buffer.push_back(rand() % 100000);
+        sortedCopy(buffer, copy);
+        std::reverse(copy.begin(), copy.end());
+        buffer.clear();
+        buffer.write(&copy[0], N);
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    const double baseline = ns(t0, t1, repeats), baselineSort = ns(t1, t2, repeats / 4 + 1);
+
+    // current code
+    srand(1);
+    buffer.clear();
+    for (int i = 0; i < N + N / 3; i++)    buffer.push_back(rand() % 100000);
+    t0 = std::chrono::steady_clock::now();
+    srand(2);
+    for (int r = 0; r < repeats; r++)
+    {
+        buffer.push_back(rand() % 100000);
+        sum2 += buffer.max();
+    }
+    t1 = std::chrono::steady_clock::now();
+    srand(2);
+    for (int r = 0; r < repeats; r++)
+    {
+        buffer.push_back(rand() % 100000);
+        sum2 += buffer.min();
+    }
+    t2 = std::chrono::steady_clock::now();
+    srand(2);
+    for (int r = 0; r < repeats; r++)
+    {
+        buffer.push_back(rand() % 100000);
+        sum2 += buffer.median();
+    }
+    const std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats / 4 + 1; r++)
+    {
+        buffer.push_back(rand() % 100000);
+        buffer.sort_descending();
+    }
+    const std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
+
+    // same results as the sorted copy
+    for (int r = 0; r < 200; r++)
+    {
+        buffer.push_back(rand() % 100000);
+        sortedCopy(buffer, copy);
+        const long median = (N % 2) ? copy[N / 2] : (copy[N / 2 - 1] + copy[N / 2]) / 2;
+        if (buffer.max() != copy.back() || buffer.min() != copy.front() || buffer.median() != median)    errors++;
+    }
+    buffer.sort_descending();
+    for (int i = 0; i < N; i++)
+        if (buffer.peek(i) != copy[N - 1 - i])    errors++;
+
+    printf("window %5u: copy+sort %9.0f ns, max %7.0f ns, min %7.0f ns, median %8.0f ns; "
+           "sort_descending %9.0f ns (copy+sort %9.0f ns); %d errors\n",
+           N, baseline, ns(t0, t1, repeats), ns(t1, t2, repeats), ns(t2, t3, repeats),
+           ns(t3, t4, repeats / 4 + 1), baselineSort, errors);
+    sink = sum1 + sum2;
+}
+
+int main()
+{
+    bench<32>();
+    bench<256>();
+    bench<1024>();
+    bench<4096>();
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Time of BITalino::version() when the device has a backlog of frames to drain before the reply,
+// as after a reconnection during an acquisition. The device is simulated on the slave side of a
+// PtyTransport: it answers each version command with the backlog, then the version string.
+
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bitalino.h"
+#include "transport.h"
+
+static std::atomic<int> backlog(0);
+static std::atomic<bool> quit(false);
+
+// plays the device on the slave side of the pseudo-terminal
+static void device(int slave)
+{
+    // frame-like bytes, without the 'B' of the version header
+    std::vector<unsigned char> frames(1 << 20);
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        frames[i] = (unsigned char) ((i * 37 + 11) & 0x7F);
+        if (frames[i] == 'B')    frames[i] = 'b';
+    }
+
+    const char *reply = "BITalino_v5.2\n";
+    unsigned char cmd;
+    while (!quit && read(slave, &cmd, 1) == 1)
+    {
+        if (cmd != 0x07)    continue;    // not a version command
+        const int n = backlog;
+        int written = 0;
+        while (written < n)
+        {
+            const int w = (int) write(slave, &frames[written], n - written);
+            if (w > 0)    written += w;
+        }
+        if (write(slave, reply, strlen(reply)) < 0)    break;
+    }
+}
+
+int main()
+{
+    PtyTransport *transport = new PtyTransport();
+    const int slave = open(transport->slaveName(), O_RDWR | O_NOCTTY);
+    termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    std::thread simulator(device, slave);
+
+    {
+        BITalino dev(transport);
+        const int sizes[] = {0, 8192, 65536, 1 << 20};
+        for (int k = 0; k < 4; k++)
+        {
+            backlog = sizes[k];
+            const int repeats = (sizes[k] >= 65536) ? 5 : 20;
+            std::string version;
+            double us = 0;
+            for (int r = 0; r < repeats; r++)
+            {
+                // let the command spacing elapse, so that only the exchange and the drain are timed
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+                version = dev.version();
+                us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / repeats;
+            }
+            printf("backlog %7d bytes: %10.0f us per version() [%s]\n", sizes[k], us, version.c_str());
+        }
+        quit = true;
+    }
+
+    close(slave);
+    simulator.join();
+    return 0;
+}
@@ -36,14 +36,12 @@
 
 #include <stdlib.h>
 #include <string.h>
-#include <fcntl.h>
-#include <termios.h>
 #include <unistd.h>
+#include <sys/select.h>
 
 #ifdef HASBLUETOOTH  // Linux only
 
 #include <bluetooth/bluetooth.h>
-#include <bluetooth/rfcomm.h>
 #include <bluetooth/hci.h>
 #include <bluetooth/hci_lib.h>
 #include <stdlib.h>
@@ -59,31 +57,115 @@ void Sleep(int millisecs)
 
 
 #include "bitalino.h"
+#include "crc4.h"
+#include "transport.h"
 
 /*****************************************************************************/
 
-// CRC4 check function
+// Returns the first occurrence of a string in a block, or NULL if not found.
+// memchr() skips quickly over the bytes which cannot start the string.
+static const unsigned char* findHeader(const unsigned char *data, int len, const char *str, int strLen)
+{
+   if (len < strLen)    return NULL;
+
+   const unsigned char *end = data + len - strLen + 1;
+   for(const unsigned char *p = data; p < end; p++)
+   {
+      p = (const unsigned char *) memchr(p, str[0], end - p);
+      if (p == NULL)    return NULL;
+      if (memcmp(p, str, strLen) == 0)    return p;
+   }
+   return NULL;
+}
 
-static const unsigned char CRC4tab[16] = {0, 3, 6, 5, 12, 15, 10, 9, 11, 8, 13, 14, 7, 4, 1, 2};
+/*****************************************************************************/
+
+// Frame decoding functions specialized for each number of acquired channels
+
+// Frame size in bytes when nChannels analog channels are acquired
+template<int nChannels>
+struct FrameLayout
+{
+   enum { nBytes = (nChannels >= 3 && nChannels <= 5) ? nChannels + 3 : nChannels + 2 };
+};
 
-static bool checkCRC4(const unsigned char *data, int len)
+template<int nChannels>
+static void unpackFrames(const unsigned char *buffer, int nFrames, BITalino::Frame *frames)
 {
-   unsigned char crc = 0;
+   const int nBytes = FrameLayout<nChannels>::nBytes;
 
-   for (int i = 0; i < len-1; i++)
+   for (int n = 0; n < nFrames; n++, buffer += nBytes)
    {
-      const unsigned char b = data[i];
-      crc = CRC4tab[crc] ^ (b >> 4);
-      crc = CRC4tab[crc] ^ (b & 0x0F);
+      BITalino::Frame &f = frames[n];
+
+      f.seq = buffer[nBytes-1] >> 4;
+      for(int i = 0; i < 4; i++)
+         f.digital[i] = ((buffer[nBytes-2] & (0x80 >> i)) != 0);
+
+      // conditions below are compile-time constants
+      f.analog[0] = (short(buffer[nBytes-2] & 0x0F) << 6) | (buffer[nBytes-3] >> 2);
+      if (nChannels > 1)
+         f.analog[1] = (short(buffer[nBytes-3] & 0x03) << 8) | buffer[nBytes-4];
+      if (nChannels > 2)
+         f.analog[2] = (short(buffer[nBytes-5]) << 2) | (buffer[nBytes-6] >> 6);
+      if (nChannels > 3)
+         f.analog[3] = (short(buffer[nBytes-6] & 0x3F) << 4) | (buffer[nBytes-7] >> 4);
+      if (nChannels > 4)
+         f.analog[4] = ((buffer[nBytes-7] & 0x0F) << 2) | (buffer[nBytes-8] >> 6);
+      if (nChannels > 5)
+         f.analog[5] = buffer[nBytes-8] & 0x3F;
    }
+}
+
+// Digital ports bits in a frame are I1 I2 I3 I4 from MSB to LSB; FrameBatch::digital has port i at bit i
+static const unsigned char digitalBits[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+
+template<int nChannels>
+static void unpackFrames(const unsigned char *buffer, int nFrames, BITalino::FrameBatch &frames, int offset)
+{
+   const int nBytes = FrameLayout<nChannels>::nBytes;
 
-   // CRC for last byte
-   crc = CRC4tab[crc] ^ (data[len-1] >> 4);
-   crc = CRC4tab[crc];
+   char          *seq = &frames.seq[offset];
+   unsigned char *digital = &frames.digital[offset];
+   short         *analog[6];
+   for(int i = 0; i < nChannels; i++)
+      analog[i] = &frames.analog[i][offset];
 
-   return (crc == (data[len-1] & 0x0F));
+   for (int n = 0; n < nFrames; n++, buffer += nBytes)
+   {
+      seq[n] = buffer[nBytes-1] >> 4;
+      digital[n] = digitalBits[buffer[nBytes-2] >> 4];
+
+      // conditions below are compile-time constants
+      analog[0][n] = (short(buffer[nBytes-2] & 0x0F) << 6) | (buffer[nBytes-3] >> 2);
+      if (nChannels > 1)
+         analog[1][n] = (short(buffer[nBytes-3] & 0x03) << 8) | buffer[nBytes-4];
+      if (nChannels > 2)
+         analog[2][n] = (short(buffer[nBytes-5]) << 2) | (buffer[nBytes-6] >> 6);
+      if (nChannels > 3)
+         analog[3][n] = (short(buffer[nBytes-6] & 0x3F) << 4) | (buffer[nBytes-7] >> 4);
+      if (nChannels > 4)
+         analog[4][n] = ((buffer[nBytes-7] & 0x0F) << 2) | (buffer[nBytes-8] >> 6);
+      if (nChannels > 5)
+         analog[5][n] = buffer[nBytes-8] & 0x3F;
+   }
 }
 
+// Frame size and decoding functions for 1...6 acquired channels, selected in BITalino::start()
+static const struct
+{
+   int   nBytes;
+   int  (*check)(const unsigned char *data, int nFrames);
+   void (*unpack)(const unsigned char *data, int nFrames, BITalino::Frame *frames);
+   void (*unpackBatch)(const unsigned char *data, int nFrames, BITalino::FrameBatch &frames, int offset);
+} frameCodecs[6] = {
+   {FrameLayout<1>::nBytes, checkCRC4Frames<FrameLayout<1>::nBytes>, unpackFrames<1>, unpackFrames<1>},
+   {FrameLayout<2>::nBytes, checkCRC4Frames<FrameLayout<2>::nBytes>, unpackFrames<2>, unpackFrames<2>},
+   {FrameLayout<3>::nBytes, checkCRC4Frames<FrameLayout<3>::nBytes>, unpackFrames<3>, unpackFrames<3>},
+   {FrameLayout<4>::nBytes, checkCRC4Frames<FrameLayout<4>::nBytes>, unpackFrames<4>, unpackFrames<4>},
+   {FrameLayout<5>::nBytes, checkCRC4Frames<FrameLayout<5>::nBytes>, unpackFrames<5>, unpackFrames<5>},
+   {FrameLayout<6>::nBytes, checkCRC4Frames<FrameLayout<6>::nBytes>, unpackFrames<6>, unpackFrames<6>}};
+
 /*****************************************************************************/
 
 // BITalino public methods
@@ -197,9 +279,12 @@ BITalino::VDevInfo BITalino::find(void)
 
 /*****************************************************************************/
 
-BITalino::BITalino(const char *address) : nChannels(0), isBitalino2(false)
-{
 #ifdef _WIN32
+
+BITalino::BITalino(const char *address) : nChannels(0), isBitalino2(false), frameSize(0), frameCheck(NULL), frameUnpack(NULL), batchUnpack(NULL), rxBegin(0), rxEnd(0), synced(true), nextSeq(-1), commandSent(false)
+{
+   stats.resyncs = stats.skippedBytes = stats.gaps = stats.lostFrames = 0;
+
    if (_memicmp(address, "COM", 3) == 0)
    {
       fd = INVALID_SOCKET;
@@ -307,93 +392,32 @@ BITalino::BITalino(const char *address) : nChannels(0), isBitalino2(false)
       readtimeout.tv_usec = 0;
    }
 
-#else // Linux or Mac OS
+   checkVersion();
+}
 
-   if (memcmp(address, "/dev/", 5) == 0)
-   {   
-      fd = open(address, O_RDWR | O_NOCTTY | O_NDELAY);
-      if (fd < 0)
-		   throw Exception(Exception::PORT_COULD_NOT_BE_OPENED);
-      
-      if (fcntl(fd, F_SETFL, 0) == -1)  // remove the O_NDELAY flag
-      {
-         close();
-		   throw Exception(Exception::PORT_INITIALIZATION);
-      }
-   
-      termios term;
-      if (tcgetattr(fd, &term) != 0)
-      {
-         close();
-		   throw Exception(Exception::PORT_INITIALIZATION);
-      }
-   
-      cfmakeraw(&term);
-      term.c_oflag &= ~(OPOST);
-   
-      term.c_cc[VMIN] = 1;
-      term.c_cc[VTIME] = 1;
-   
-      term.c_iflag &= ~(INPCK | PARMRK | ISTRIP | IGNCR | ICRNL | INLCR | IXON | IXOFF | IMAXBEL); // no flow control
-      term.c_iflag |= (IGNPAR | IGNBRK);
-   
-      term.c_cflag &= ~(CRTSCTS | PARENB | CSTOPB | CSIZE); // no parity, 1 stop bit
-      term.c_cflag |= (CLOCAL | CREAD | CS8);    // raw mode, 8 bits
-   
-      term.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHOPRT | ECHOK | ECHOKE | ECHONL | ECHOCTL | ISIG | IEXTEN | TOSTOP);  // raw mode
-   
-      if (cfsetspeed(&term, B115200) != 0)
-      {
-         close();
-		   throw Exception(Exception::PORT_INITIALIZATION);
-      }
-   
-      if (tcsetattr(fd, TCSANOW, &term) != 0)
-      {
-         close();
-		   throw Exception(Exception::PORT_INITIALIZATION);
-      }
+#else // Linux or Mac OS
 
-      isTTY = true;
-   }
-   else // address is a Bluetooth MAC address
-#ifdef HASBLUETOOTH
-   {
-      sockaddr_rc so_bt;
-      so_bt.rc_family = AF_BLUETOOTH;
-      if (str2ba(address, &so_bt.rc_bdaddr) < 0)
-         throw Exception(Exception::INVALID_ADDRESS);
-         
-      so_bt.rc_channel = 1;
+BITalino::BITalino(const char *address) : BITalino(Transport::open(address)) {}
 
-      fd = socket(AF_BLUETOOTH, SOCK_STREAM, BTPROTO_RFCOMM);
-      if (fd < 0)
-         throw Exception(Exception::PORT_INITIALIZATION);
+/*****************************************************************************/
 
-      if (connect(fd, (const sockaddr*)&so_bt, sizeof so_bt) != 0)
-      {
-         close();
-         throw Exception(Exception::PORT_COULD_NOT_BE_OPENED);
-      }
+BITalino::BITalino(Transport *transport) : nChannels(0), isBitalino2(false), frameSize(0), frameCheck(NULL), frameUnpack(NULL), batchUnpack(NULL), rxBegin(0), rxEnd(0), synced(true), nextSeq(-1), commandSent(false), transport(transport)
+{
+   stats.resyncs = stats.skippedBytes = stats.gaps = stats.lostFrames = 0;
 
-      isTTY = false;
+   try
+   {
+      checkVersion();
    }
-#else
-      throw Exception(Exception::PORT_COULD_NOT_BE_OPENED);
-#endif // HASBLUETOOTH
-
-#endif // Linux or Mac OS
-
-   // check if device is BITalino2
-   const std::string ver = version();
-   const std::string::size_type pos = ver.find("_v");
-   if (pos != std::string::npos)
+   catch (Exception)
    {
-      const char *xver = ver.c_str() + pos+2;
-      if (atoi(xver) >= 5)  isBitalino2 = true;
+      close();
+      throw;
    }
 }
 
+#endif // Linux or Mac OS
+
 /*****************************************************************************/
 
 BITalino::~BITalino(void)
@@ -415,31 +439,55 @@ std::string BITalino::version(void)
    
    const char *header = "BITalino";
    
-   const size_t headerLen = strlen(header);
+   const int headerLen = (int) strlen(header);
 
    send(0x07);    // 0  0  0  0  0  1  1  1 - Send version string
    
-   std::string str;
+   // Drain the input in large blocks (it may hold many frames still in flight after stop()) into the
+   // staging buffer, and search each block for the version header and then for the terminating newline.
+   int n = 0;           // number of bytes in rxBuf
+   bool found = false;  // true if rxBuf starts with the version header
    while(1)
    {
-      char chr;
-      if (recv(&chr, sizeof chr) != sizeof chr)    // a timeout has occurred
+      const int nread = recvAvailable(rxBuf+n, sizeof rxBuf - n, true);
+      if (nread == 0)    // a timeout has occurred
          throw Exception(Exception::CONTACTING_DEVICE);
 
-      const size_t len = str.size();
-      if (len >= headerLen)
+      const int prev = n;
+      const bool searched = found;   // true if rxBuf[headerLen...prev-1] has no newline
+      n += nread;
+
+      if (!found)
       {
-         if (chr == '\n')  return str;
-         str.push_back(chr);
+         const unsigned char *hdr = findHeader(rxBuf, n, header, headerLen);
+         if (hdr == NULL)
+         {
+            // discard all data before version header, but keep a partial header at the end of the block
+            const int keep = (n < headerLen-1) ? n : headerLen-1;
+            memmove(rxBuf, rxBuf + n-keep, keep);
+            n = keep;
+            continue;
+         }
+
+         n -= int(hdr - rxBuf);
+         memmove(rxBuf, hdr, n);
+         found = true;
       }
-      else
-         if (chr == header[len])
-            str.push_back(chr);
-         else
+
+      // search for the newline only in the bytes not searched before
+      const int from = (searched && prev > headerLen) ? prev : headerLen;
+      if (n > from)
+      {
+         const void *eol = memchr(rxBuf + from, '\n', n - from);
+         if (eol != NULL)
          {
-            str.clear();   // discard all data before version header
-            if (chr == header[0])   str.push_back(chr);
+            rxBegin = rxEnd = 0;
+            return std::string((const char *) rxBuf, (const unsigned char *) eol - rxBuf);
          }
+      }
+
+      if (n == sizeof rxBuf)    // version string is too long
+         throw Exception(Exception::CONTACTING_DEVICE);
    }
 }
 
@@ -489,6 +537,15 @@ void BITalino::start(int samplingRate, const Vint &channels, bool simulated)
       }
    }
 
+   frameSize = frameCodecs[nChannels-1].nBytes;
+   frameCheck = frameCodecs[nChannels-1].check;
+   frameUnpack = frameCodecs[nChannels-1].unpack;
+   batchUnpack = frameCodecs[nChannels-1].unpackBatch;
+
+   rxBegin = rxEnd = 0;   // discard any stale data in staging buffer
+   synced = true;
+   nextSeq = -1;
+
    send(cmd);   // <Fs>  0  0  0  0  1  1 - Set sampling rate
 
    // A6 A5 A4 A3 A2 A1 0  1 - Start live mode with analog channel selection
@@ -505,6 +562,7 @@ void BITalino::stop(void)
    send(0x00); // 0  0  0  0  0  0  0  0 - Go to idle mode
 
    nChannels = 0;
+   rxBegin = rxEnd = 0;
 
    version();  // to flush pending frames in input buffer
 }
@@ -513,45 +571,28 @@ void BITalino::stop(void)
 
 int BITalino::read(VFrame &frames)
 {
-   if (nChannels == 0)   throw Exception(Exception::DEVICE_NOT_IN_ACQUISITION);
-
-   unsigned char buffer[8]; // frame maximum size is 8 bytes
-
-   if (frames.empty())   frames.resize(100);
+   return readFrames(frames, true);
+}
 
-   char nBytes = nChannels + 2;
-   if (nChannels >= 3 && nChannels <= 5)  nBytes++;
+/*****************************************************************************/
 
-   for(VFrame::iterator it = frames.begin(); it != frames.end(); it++)
-   {
-      if (recv(buffer, nBytes) != nBytes)    return int(it - frames.begin());   // a timeout has occurred
+int BITalino::readAvailable(VFrame &frames)
+{
+   return readFrames(frames, false);
+}
 
-      while (!checkCRC4(buffer, nBytes))
-      {  // if CRC check failed, try to resynchronize with the next valid frame
-         // checking with one new byte at a time
-         memmove(buffer, buffer+1, nBytes-1);
-         if (recv(buffer+nBytes-1, 1) != 1)    return int(it - frames.begin());   // a timeout has occurred
-      }
+/*****************************************************************************/
 
-      Frame &f = *it;
-      f.seq = buffer[nBytes-1] >> 4;
-      for(int i = 0; i < 4; i++)
-         f.digital[i] = ((buffer[nBytes-2] & (0x80 >> i)) != 0);
+int BITalino::read(FrameBatch &frames)
+{
+   return readBatch(frames, true);
+}
 
-      f.analog[0] = (short(buffer[nBytes-2] & 0x0F) << 6) | (buffer[nBytes-3] >> 2);
-      if (nChannels > 1)
-         f.analog[1] = (short(buffer[nBytes-3] & 0x03) << 8) | buffer[nBytes-4];
-      if (nChannels > 2)
-         f.analog[2] = (short(buffer[nBytes-5]) << 2) | (buffer[nBytes-6] >> 6);
-      if (nChannels > 3)
-         f.analog[3] = (short(buffer[nBytes-6] & 0x3F) << 4) | (buffer[nBytes-7] >> 4);
-      if (nChannels > 4)
-         f.analog[4] = ((buffer[nBytes-7] & 0x0F) << 2) | (buffer[nBytes-8] >> 6);
-      if (nChannels > 5)
-         f.analog[5] = buffer[nBytes-8] & 0x3F;
-   }
+/*****************************************************************************/
 
-   return (int) frames.size();
+int BITalino::readAvailable(FrameBatch &frames)
+{
+   return readBatch(frames, false);
 }
 
 /*****************************************************************************/
@@ -649,6 +690,24 @@ BITalino::State BITalino::state(void)
 
 /*****************************************************************************/
 
+BITalino::LinkStats BITalino::linkStats(void) const
+{
+   return stats;
+}
+
+/*****************************************************************************/
+
+#ifndef _WIN32 // Linux or Mac OS
+
+int BITalino::fileDescriptor(void) const
+{
+   return transport->fd();
+}
+
+#endif // Linux or Mac OS
+
+/*****************************************************************************/
+
 const char* BITalino::Exception::getDescription(void)
 {
 	switch (code)
@@ -692,9 +751,158 @@ const char* BITalino::Exception::getDescription(void)
 
 // BITalino private methods
 
+void BITalino::checkVersion(void)
+{
+   // check if device is BITalino2
+   const std::string ver = version();
+   const std::string::size_type pos = ver.find("_v");
+   if (pos != std::string::npos)
+   {
+      const char *xver = ver.c_str() + pos+2;
+      if (atoi(xver) >= 5)  isBitalino2 = true;
+   }
+}
+
+/*****************************************************************************/
+
+int BITalino::readFrames(VFrame &frames, bool wait)
+{
+   if (nChannels == 0)   throw Exception(Exception::DEVICE_NOT_IN_ACQUISITION);
+
+   if (frames.empty())   frames.resize(100);
+
+   const int size = (int) frames.size();
+   int n = 0;
+   while (n < size)
+   {
+      const int nFrames = nextFrames(size - n, wait);
+      if (nFrames == 0)    break;   // a timeout has occurred or no more frames are available
+
+      frameUnpack(rxBuf + rxBegin, nFrames, &frames[n]);
+      rxBegin += nFrames * frameSize;
+      n += nFrames;
+   }
+
+   return n;
+}
+
+/*****************************************************************************/
+
+int BITalino::readBatch(FrameBatch &frames, bool wait)
+{
+   if (nChannels == 0)   throw Exception(Exception::DEVICE_NOT_IN_ACQUISITION);
+
+   if (frames.empty())   frames.resize(100);
+
+   const int size = (int) frames.size();
+   int n = 0;
+   while (n < size)
+   {
+      const int nFrames = nextFrames(size - n, wait);
+      if (nFrames == 0)    break;   // a timeout has occurred or no more frames are available
+
+      batchUnpack(rxBuf + rxBegin, nFrames, frames, n);
+      rxBegin += nFrames * frameSize;
+      n += nFrames;
+   }
+
+   return n;
+}
+
+/*****************************************************************************/
+
+int BITalino::nextFrames(int maxFrames, bool wait)
+{
+   // Returns the number of consecutive valid frames (up to maxFrames) at the start of the staging buffer,
+   // reading more data from the device if needed, or 0 if a timeout occurred
+   // (or if no frame is available yet when wait is false).
+   // The caller must consume the returned frames.
+   while (1)
+   {
+      if (rxEnd - rxBegin >= frameSize && (synced || resync(frameSize)))
+      {
+         // check all complete frames in one pass
+         int nFrames = (rxEnd - rxBegin) / frameSize;
+         if (nFrames > maxFrames)   nFrames = maxFrames;
+         const int nValid = frameCheck(rxBuf + rxBegin, nFrames);
+
+         int n;
+         for(n = 0; n < nValid; n++)
+         {
+            const int seq = rxBuf[rxBegin + n*frameSize + frameSize-1] >> 4;
+            if (nextSeq >= 0 && seq != nextSeq)
+            {
+               if (n > 0)   break;   // return the frames before the gap first
+
+               // valid frame out of sequence: frames were lost on the device or the link, keep this one
+               stats.gaps++;
+               stats.lostFrames += (seq - nextSeq) & 0x0F;
+            }
+            nextSeq = (seq + 1) & 0x0F;
+         }
+
+         if (n > 0)   return n;
+
+         // CRC check failed: scan the staging buffer for the next valid frame
+         synced = false;
+         stats.resyncs++;
+         stats.skippedBytes++;
+         rxBegin++;
+         continue;
+      }
+
+      // keep the unconsumed data and append all available data
+      memmove(rxBuf, rxBuf+rxBegin, rxEnd-rxBegin);
+      rxEnd -= rxBegin;
+      rxBegin = 0;
+
+      const int n = recvAvailable(rxBuf+rxEnd, sizeof rxBuf - rxEnd, wait);
+      if (n == 0)    return 0;   // a timeout has occurred
+
+      rxEnd += n;
+   }
+}
+
+/*****************************************************************************/
+
+bool BITalino::resync(int nBytes)
+{
+   // A 4-bit CRC matches random data at one offset out of 16, so a candidate offset is accepted
+   // only if it starts two consecutive valid frames with consecutive sequence numbers.
+   const int frameSpan = 2*nBytes;
+
+   int i;
+   for(i = rxBegin; i + frameSpan <= rxEnd; i++)
+   {
+      const unsigned char *buffer = rxBuf + i;
+      if (frameCheck(buffer, 2) == 2 &&
+          (((buffer[nBytes-1] >> 4) + 1) & 0x0F) == (buffer[frameSpan-1] >> 4))
+      {
+         stats.skippedBytes += i - rxBegin;
+         rxBegin = i;
+         synced = true;
+         nextSeq = -1;  // frames may have been lost
+         return true;
+      }
+   }
+
+   // no candidate found in the scanned data: discard it, but keep the bytes which may still
+   // start a valid frame pair once more data arrives
+   stats.skippedBytes += i - rxBegin;
+   rxBegin = i;
+   return false;
+}
+
+/*****************************************************************************/
+
 void BITalino::send(char cmd)
 {
-   Sleep(150);
+   // wait only for the part of the spacing which has not elapsed since the previous command was sent
+   if (commandSent)
+   {
+      const long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lastCommand).count();
+      if (elapsed < commandSpacing)   Sleep(int(commandSpacing - elapsed));
+   }
 
 #ifdef _WIN32
    if (fd == INVALID_SOCKET)
@@ -712,9 +920,11 @@ void BITalino::send(char cmd)
    
 #else // Linux or Mac OS
 
-   if (write(fd, &cmd, sizeof cmd) != sizeof cmd)
-      throw Exception(Exception::CONTACTING_DEVICE);
+   transport->write(&cmd, sizeof cmd);
 #endif
+
+   lastCommand = std::chrono::steady_clock::now();
+   commandSent = true;
 }
 
 /*****************************************************************************/
@@ -752,12 +962,16 @@ int BITalino::recv(void *data, int nbyttoread)
    readtimeout.tv_usec = 0;
 #endif
 
-   fd_set   readfds;
-   FD_ZERO(&readfds);
-   FD_SET(fd, &readfds);
-
    for(int n = 0; n < nbyttoread;)
    {
+      fd_set   readfds;
+      FD_ZERO(&readfds);
+#ifdef _WIN32
+      FD_SET(fd, &readfds);
+#else // Linux or Mac OS
+      FD_SET(transport->fd(), &readfds);
+#endif
+
       int state = select(FD_SETSIZE, &readfds, NULL, NULL, &readtimeout);
       if(state < 0)	 throw Exception(Exception::CONTACTING_DEVICE);
 
@@ -765,11 +979,11 @@ int BITalino::recv(void *data, int nbyttoread)
 
 #ifdef _WIN32
       int ret = ::recv(fd, (char *) data+n, nbyttoread-n, 0);
+      if(ret <= 0)   throw Exception(Exception::CONTACTING_DEVICE);
 #else // Linux or Mac OS
-      ssize_t ret = ::read(fd, (char *) data+n, nbyttoread-n);
+      int ret = transport->read((char *) data+n, nbyttoread-n);   // may be 0 after a spurious wake-up
 #endif
 
-      if(ret <= 0)   throw Exception(Exception::CONTACTING_DEVICE);
       n += ret;
    }
 
@@ -778,6 +992,65 @@ int BITalino::recv(void *data, int nbyttoread)
 
 /*****************************************************************************/
 
+int BITalino::recvAvailable(void *data, int maxbyttoread, bool wait)
+{
+#ifdef _WIN32
+   if (fd == INVALID_SOCKET)
+   {
+      // read all bytes already queued in the serial port, or wait for at least one byte
+      DWORD errors;
+      COMSTAT stat;
+      if (!ClearCommError(hCom, &errors, &stat))
+         throw Exception(Exception::CONTACTING_DEVICE);
+
+      int n = (int) stat.cbInQue;
+      if (n == 0)
+      {
+         if (!wait)   return 0;
+         n = 1;
+      }
+      if (n > maxbyttoread)   n = maxbyttoread;
+
+      return recv(data, n);
+   }
+
+   timeval  timeout = readtimeout;
+#else // Linux or Mac OS
+   timeval  timeout;
+   timeout.tv_sec = 5;
+   timeout.tv_usec = 0;
+#endif
+
+   if (!wait)   timeout.tv_sec = timeout.tv_usec = 0;
+
+   while (1)
+   {
+      fd_set   readfds;
+      FD_ZERO(&readfds);
+#ifdef _WIN32
+      FD_SET(fd, &readfds);
+#else // Linux or Mac OS
+      FD_SET(transport->fd(), &readfds);
+#endif
+
+      int state = select(FD_SETSIZE, &readfds, NULL, NULL, &timeout);
+      if(state < 0)	 throw Exception(Exception::CONTACTING_DEVICE);
+
+      if (state == 0)   return 0;   // a timeout occurred
+
+#ifdef _WIN32
+      int ret = ::recv(fd, (char *) data, maxbyttoread, 0);
+      if(ret <= 0)   throw Exception(Exception::CONTACTING_DEVICE);
+#else // Linux or Mac OS
+      int ret = transport->read(data, maxbyttoread);   // may be 0 after a spurious wake-up
+#endif
+
+      if (ret > 0)   return ret;
+   }
+}
+
+/*****************************************************************************/
+
 void BITalino::close(void)
 {
 #ifdef _WIN32
@@ -791,7 +1064,7 @@ void BITalino::close(void)
    
 #else // Linux or Mac OS
 
-   ::close(fd);
+   delete transport;
 
 #endif
 }
@@ -0,0 +1,188 @@
+#ifndef BIQUADBANK_H
+#define BIQUADBANK_H
+
+#include <stddef.h>
+#include <vector>
+
+#if defined(__AVX__) && !defined(BIQUADBANK_NO_SIMD)
+#include <immintrin.h>
+#elif (defined(__SSE__) || defined(_M_X64)) && !defined(BIQUADBANK_NO_SIMD)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) && !defined(BIQUADBANK_NO_SIMD)
+#include <arm_neon.h>
+#endif
+
+#include "BiquadFilter.h"
+
+// Bank of biquad cascades filtering up to 8 channels at once, one SIMD lane per channel
+// (AVX: one 8-lane register, SSE or NEON: two 4-lane registers, otherwise a scalar loop).
+// All channels share the same structure (number of sections) but each has its own coefficients,
+// taken from a BiquadCascade design. State and coefficients are float.
+// Each lane computes exactly the operations of BiquadCascade<float>::step() in the same order, so the
+// output is bit-identical to a BiquadCascade<float> with the same design, unless the compiler contracts
+// multiply-adds into fused multiply-adds (-ffp-contract with FMA, for instance on ARM64 or with -mfma).
+// The outputs then differ by up to 1e-4 of the channel's peak output at 100 Hz and 5e-3 at 1000 Hz, the
+// worst being the narrow low bands (0.1-1 Hz), whose poles are the closest to 1. test/biquad_bank.cpp
+// checks both on the AVX, SSE and scalar lanes (BIQUADBANK_NO_SIMD selects the scalar loop); the NEON
+// lanes are only checked when it is built on ARM.
+class BiquadBank
+{
+  public:
+    static const int maxChannels = 8;
+
+    //  Default
+    // channels filters (1 to 8), all with the given design
+    BiquadBank(int channels, const BiquadCascade<double> &design) : nChannels(channels < maxChannels ? channels : maxChannels), sections(design.getSections())
+    {
+      for (int c = 0; c < nChannels; c++)
+        setChannel(c, design);
+    };
+    //
+
+    //  Public
+    // gives channel its own design, which must have as many sections as the bank
+    bool setChannel(int channel, const BiquadCascade<double> &design)
+    {
+      if (channel < 0 || channel >= nChannels || design.getSections() != (int) sections.size())
+        return false;
+
+      for (size_t k = 0; k < sections.size(); k++)
+      {
+        double b0, b1, b2, a1, a2;
+        design.getSection((int) k, b0, b1, b2, a1, a2);
+        Section &s = sections[k];
+        s.b0[channel] = float(b0);
+        s.b1[channel] = float(b1);
+        s.b2[channel] = float(b2);
+        s.a1[channel] = float(a1);
+        s.a2[channel] = float(a2);
+        s.z1[channel] = s.z2[channel] = 0;
+      }
+      return true;
+    };
+
+    // filters a block of n samples of each channel: in[c] and out[c] are the arrays of channel c
+    // (in[c] and out[c] may be the same array when U is float)
+    template<typename U>
+    void step(const U *const *in, float *const *out, size_t n)
+    {
+      if (n == 0) return;
+
+      // interleave the channels, one 8-lane group per sample
+      work.resize(n * maxChannels);
+      for (size_t i = 0; i < n; i++)
+        for (int c = 0; c < maxChannels; c++)
+          work[i*maxChannels + c] = (c < nChannels) ? float(in[c][i]) : 0.f;
+
+      // run the block through two sections at a time, with their coefficients and state in registers
+      // (as in BiquadCascade::step(), the two recursions run in parallel)
+      float *x = &work[0];
+      for (size_t k = 0; k < sections.size(); k += 2)
+      {
+        Section &s = sections[k];
+        const Lanes b0 = load(s.b0), b1 = load(s.b1), b2 = load(s.b2), a1 = load(s.a1), a2 = load(s.a2);
+        Lanes z1 = load(s.z1), z2 = load(s.z2);
+        if (k + 1 == sections.size())
+        {
+          for (size_t i = 0; i < n; i++)
+          {
+            const Lanes xi = load(x + i*maxChannels);
+            const Lanes y = add(mul(b0, xi), z1);
+            z1 = add(sub(mul(b1, xi), mul(a1, y)), z2);
+            z2 = sub(mul(b2, xi), mul(a2, y));
+            store(x + i*maxChannels, y);
+          }
+        }
+        else
+        {
+          Section &t = sections[k+1];
+          const Lanes c0 = load(t.b0), c1 = load(t.b1), c2 = load(t.b2), d1 = load(t.a1), d2 = load(t.a2);
+          Lanes w1 = load(t.z1), w2 = load(t.z2);
+          for (size_t i = 0; i < n; i++)
+          {
+            const Lanes xi = load(x + i*maxChannels);
+            const Lanes y = add(mul(b0, xi), z1);
+            z1 = add(sub(mul(b1, xi), mul(a1, y)), z2);
+            z2 = sub(mul(b2, xi), mul(a2, y));
+            const Lanes v = add(mul(c0, y), w1);
+            w1 = add(sub(mul(c1, y), mul(d1, v)), w2);
+            w2 = sub(mul(c2, y), mul(d2, v));
+            store(x + i*maxChannels, v);
+          }
+          store(t.z1, w1);
+          store(t.z2, w2);
+        }
+        store(s.z1, z1);
+        store(s.z2, z2);
+      }
+
+      for (size_t i = 0; i < n; i++)
+        for (int c = 0; c < nChannels; c++)
+          out[c][i] = work[i*maxChannels + c];
+    };
+    void step(float *const *data, size_t n) { step((const float *const *) data, data, n); }
+
+    void reset()
+    {
+      for (size_t k = 0; k < sections.size(); k++)
+        for (int c = 0; c < maxChannels; c++)
+          sections[k].z1[c] = sections[k].z2[c] = 0;
+    };
+    //
+
+    //  Set/get
+    int getChannels() const { return nChannels; }
+    //
+
+  protected:
+    struct Section
+    {
+      Section()
+      {
+        for (int c = 0; c < maxChannels; c++)
+          b0[c] = b1[c] = b2[c] = a1[c] = a2[c] = z1[c] = z2[c] = 0;
+      }
+      float b0[maxChannels], b1[maxChannels], b2[maxChannels];   // numerator
+      float a1[maxChannels], a2[maxChannels];                    // denominator (a0 = 1)
+      float z1[maxChannels], z2[maxChannels];                    // state
+    };
+
+    // 8 float lanes
+#if defined(__AVX__) && !defined(BIQUADBANK_NO_SIMD)
+    typedef __m256 Lanes;
+    static Lanes load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, Lanes v) { _mm256_storeu_ps(p, v); }
+    static Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+    static Lanes sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+    static Lanes mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+#elif (defined(__SSE__) || defined(_M_X64)) && !defined(BIQUADBANK_NO_SIMD)
+    struct Lanes { __m128 lo, hi; };
+    static Lanes load(const float *p) { Lanes v = { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; return v; }
+    static void store(float *p, Lanes v) { _mm_storeu_ps(p, v.lo); _mm_storeu_ps(p + 4, v.hi); }
+    static Lanes add(Lanes a, Lanes b) { Lanes v = { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; return v; }
+    static Lanes sub(Lanes a, Lanes b) { Lanes v = { _mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi) }; return v; }
+    static Lanes mul(Lanes a, Lanes b) { Lanes v = { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; return v; }
+#elif defined(__ARM_NEON) && !defined(BIQUADBANK_NO_SIMD)
+    struct Lanes { float32x4_t lo, hi; };
+    static Lanes load(const float *p) { Lanes v = { vld1q_f32(p), vld1q_f32(p + 4) }; return v; }
+    static void store(float *p, Lanes v) { vst1q_f32(p, v.lo); vst1q_f32(p + 4, v.hi); }
+    static Lanes add(Lanes a, Lanes b) { Lanes v = { vaddq_f32(a.lo, b.lo), vaddq_f32(a.hi, b.hi) }; return v; }
+    static Lanes sub(Lanes a, Lanes b) { Lanes v = { vsubq_f32(a.lo, b.lo), vsubq_f32(a.hi, b.hi) }; return v; }
+    static Lanes mul(Lanes a, Lanes b) { Lanes v = { vmulq_f32(a.lo, b.lo), vmulq_f32(a.hi, b.hi) }; return v; }
+#else
+    struct Lanes { float v[maxChannels]; };
+    static Lanes load(const float *p) { Lanes r; for (int c = 0; c < maxChannels; c++) r.v[c] = p[c]; return r; }
+    static void store(float *p, Lanes a) { for (int c = 0; c < maxChannels; c++) p[c] = a.v[c]; }
+    static Lanes add(Lanes a, Lanes b) { for (int c = 0; c < maxChannels; c++) a.v[c] += b.v[c]; return a; }
+    static Lanes sub(Lanes a, Lanes b) { for (int c = 0; c < maxChannels; c++) a.v[c] -= b.v[c]; return a; }
+    static Lanes mul(Lanes a, Lanes b) { for (int c = 0; c < maxChannels; c++) a.v[c] *= b.v[c]; return a; }
+#endif
+
+    //  Attributes
+    int nChannels;
+    std::vector<Section> sections;
+    std::vector<float> work;      // interleaved block, maxChannels values per sample
+    //
+};
+
+#endif // BIQUADBANK_H
@@ -0,0 +1,225 @@
+#ifndef BIQUADFILTER_H
+#define BIQUADFILTER_H
+
+#include <algorithm>
+#include <complex>
+#include <math.h>
+#include <vector>
+
+// Cascade of second-order sections (biquads) in transposed direct form II.
+// The constructor designs a Butterworth low-pass, high-pass, band-pass or band-stop (notch) filter
+// of any order with the bilinear transform, prewarping the cut-off frequencies so that the digital
+// filter is -3 dB exactly at them. Coefficients and state are kept in T (float or double), so that
+// integer samples are only converted once on input.
+// Low-pass and high-pass filters of order N use (N+1)/2 sections, band-pass and band-stop filters
+// of order N (2N poles) use N sections.
+template<typename T>
+class BiquadCascade
+{
+  public:
+    enum Type { LowPass, HighPass, BandPass, BandStop };
+
+    //  Default
+    // LowPass or HighPass at cutOffFrequency (0 < cutOffFrequency < samplingRate/2)
+    BiquadCascade(Type type, double samplingRate, double cutOffFrequency, int order = 2) : yn0(0)
+    {
+      design(type, samplingRate, cutOffFrequency, cutOffFrequency, order);
+    };
+    // BandPass or BandStop between lowFrequency and highFrequency (0 < lowFrequency < highFrequency < samplingRate/2)
+    BiquadCascade(Type type, double samplingRate, double lowFrequency, double highFrequency, int order) : yn0(0)
+    {
+      design(type, samplingRate, lowFrequency, highFrequency, order);
+    };
+    //
+
+    //  Public
+    T step(T command)
+    {
+      T x = command;
+      for (size_t i = 0; i < sections.size(); i++)
+      {
+        Section &s = sections[i];
+        const T y = s.b0*x + s.z1;
+        s.z1 = s.b1*x - s.a1*y + s.z2;
+        s.z2 = s.b2*x - s.a2*y;
+        x = y;
+      }
+      yn0 = x;
+      return yn0;
+    };
+
+    // filters a block of n samples (in and out may be the same array)
+    // the block goes through two sections at a time, with their coefficients and state kept in locals:
+    // the two recursions are independent within a sample, so that they run in parallel
+    void step(const T *in, T *out, size_t n)
+    {
+      if (n == 0) return;
+      if (sections.empty() && in != out) std::copy(in, in + n, out);
+      for (size_t k = 0; k < sections.size(); k += 2)
+      {
+        const T *src = (k == 0) ? in : out;
+        Section &s = sections[k];
+        const T b0 = s.b0, b1 = s.b1, b2 = s.b2, a1 = s.a1, a2 = s.a2;
+        T z1 = s.z1, z2 = s.z2;
+        if (k + 1 == sections.size())
+        {
+          for (size_t i = 0; i < n; i++)
+          {
+            const T x = src[i];
+            const T y = b0*x + z1;
+            z1 = b1*x - a1*y + z2;
+            z2 = b2*x - a2*y;
+            out[i] = y;
+          }
+        }
+        else
+        {
+          Section &t = sections[k+1];
+          const T c0 = t.b0, c1 = t.b1, c2 = t.b2, d1 = t.a1, d2 = t.a2;
+          T w1 = t.z1, w2 = t.z2;
+          for (size_t i = 0; i < n; i++)
+          {
+            const T x = src[i];
+            const T y = b0*x + z1;
+            z1 = b1*x - a1*y + z2;
+            z2 = b2*x - a2*y;
+            const T v = c0*y + w1;
+            w1 = c1*y - d1*v + w2;
+            w2 = c2*y - d2*v;
+            out[i] = v;
+          }
+          t.z1 = w1;
+          t.z2 = w2;
+        }
+        s.z1 = z1;
+        s.z2 = z2;
+      }
+      yn0 = out[n-1];
+    };
+    void step(T *data, size_t n) { step(data, data, n); }
+
+    void reset()
+    {
+      for (size_t i = 0; i < sections.size(); i++)
+        sections[i].z1 = sections[i].z2 = T(0);
+      yn0 = T(0);
+    };
+    //
+
+    //  Set/get
+    T getValue() const { return yn0; }
+    int getSections() const { return (int) sections.size(); }
+    // group delay (samples) at frequency, -d(phase)/d(omega) of each section's numerator minus its denominator
+    double getGroupDelay(double samplingRate, double frequency) const
+    {
+      const double pi = 3.14159265358979323846;
+      const complex z1 = std::polar(1.0, -2 * pi * frequency / samplingRate), z2 = z1 * z1;
+      double delay = 0;
+      for (size_t i = 0; i < sections.size(); i++)
+      {
+        const Section &s = sections[i];
+        const complex b = double(s.b0) + double(s.b1) * z1 + double(s.b2) * z2;
+        const complex a = 1.0 + double(s.a1) * z1 + double(s.a2) * z2;
+        delay += ((double(s.b1) * z1 + 2.0 * double(s.b2) * z2) / b).real() - ((double(s.a1) * z1 + 2.0 * double(s.a2) * z2) / a).real();
+      }
+      return delay;
+    }
+    // coefficients of section k (a0 = 1)
+    void getSection(int k, T &b0, T &b1, T &b2, T &a1, T &a2) const
+    {
+      const Section &s = sections[k];
+      b0 = s.b0; b1 = s.b1; b2 = s.b2; a1 = s.a1; a2 = s.a2;
+    }
+    //
+
+  protected:
+    typedef std::complex<double> complex;
+
+    struct Section
+    {
+      T b0, b1, b2;   // numerator
+      T a1, a2;       // denominator (a0 = 1)
+      T z1, z2;       // state
+    };
+
+    void design(Type type, double samplingRate, double f1, double f2, int order)
+    {
+      const double pi = 3.14159265358979323846;
+      const double fs2 = 2 * samplingRate;
+      if (order < 1) order = 1;
+
+      // prewarped analog frequencies, geometric center and bandwidth
+      const double w1 = fs2 * tan(pi * f1 / samplingRate);
+      const double w2 = fs2 * tan(pi * f2 / samplingRate);
+      const double w0 = sqrt(w1 * w2);
+      const double bw = w2 - w1;
+
+      // unit gain at DC (low-pass, band-stop), Nyquist (high-pass) or center frequency (band-pass)
+      complex ref = 1;
+      if (type == HighPass) ref = -1;
+      else if (type == BandPass) ref = bilinear(complex(0, w0), fs2);
+
+      const complex notch = bilinear(complex(0, w0), fs2);
+
+      sections.clear();
+      for (int k = 0; k < (order + 1) / 2; k++)
+      {
+        // Butterworth prototype pole in the upper left quadrant, or -1 for the last pole of an odd order
+        const complex p = std::polar(1.0, pi * (2*k + order + 1) / (2.0 * order));
+        const bool single = (2*k + 1 == order);
+
+        if (type == LowPass || type == HighPass)
+        {
+          const complex s = (type == LowPass) ? p * w1 : w1 / p;
+          const complex z = bilinear(s, fs2);
+          const complex zero = (type == LowPass) ? -1 : 1;
+          if (single) add(z.real(), 0, zero, 0, ref);
+          else add(z, std::conj(z), zero, zero, ref);
+        }
+        else
+        {
+          // each prototype pole maps to the two roots of s^2 - (p*bw)s + w0^2 (band-pass)
+          // or s^2 - (bw/p)s + w0^2 (band-stop)
+          const complex h = (type == BandPass) ? p * bw / 2.0 : bw / (2.0 * p);
+          const complex d = std::sqrt(h*h - w0*w0);
+          const complex za = bilinear(h + d, fs2), zb = bilinear(h - d, fs2);
+          const complex zero1 = (type == BandPass) ? complex(1) : notch;
+          const complex zero2 = (type == BandPass) ? complex(-1) : std::conj(notch);
+          if (single) add(za, zb, zero1, zero2, ref);
+          else
+          {
+            add(za, std::conj(za), zero1, zero2, ref);
+            add(zb, std::conj(zb), zero1, zero2, ref);
+          }
+        }
+      }
+      reset();
+    };
+
+    static complex bilinear(complex s, double fs2) { return (fs2 + s) / (fs2 - s); }
+
+    // appends the section with poles pa, pb and zeros za, zb (0 for a first-order section), normalized to unit gain at ref
+    void add(complex pa, complex pb, complex za, complex zb, complex ref)
+    {
+      const double a1 = -(pa + pb).real(), a2 = (pa * pb).real();
+      const double b1 = -(za + zb).real(), b2 = (za * zb).real();
+      const complex r = 1.0 / ref;
+      const double gain = std::abs((1.0 + a1*r + a2*r*r) / (1.0 + b1*r + b2*r*r));
+
+      Section s;
+      s.b0 = T(gain);
+      s.b1 = T(gain * b1);
+      s.b2 = T(gain * b2);
+      s.a1 = T(a1);
+      s.a2 = T(a2);
+      s.z1 = s.z2 = T(0);
+      sections.push_back(s);
+    };
+
+    //  Attributes
+    std::vector<Section> sections;
+    T yn0;
+    //
+};
+
+#endif // BIQUADFILTER_H
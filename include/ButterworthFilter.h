@@ -1,4 +1,5 @@
 #include <math.h>
+#include <stddef.h>
 
 template<typename T>
 class ButterworthFilter
@@ -28,6 +29,27 @@ class ButterworthFilter
       xn1 = command;
       return yn0; 
     };
+
+    // filters a block of n samples (in and out may be the same array), with the state kept in locals
+    void step(const T *in, T *out, size_t n)
+    {
+      T y0 = yn0, y1 = yn1, y2 = yn2;
+      T x1 = xn1, x2 = xn2;
+      for (size_t i = 0; i < n; i++)
+      {
+        const T x0 = in[i];
+        y0 = x0 + 2*x1 + x2 - b*y1 - c*y2;
+        y0 /= a;
+        y2 = y1;
+        y1 = y0;
+        x2 = x1;
+        x1 = x0;
+        out[i] = y0;
+      }
+      yn0 = y0; yn1 = y1; yn2 = y2;
+      xn1 = x1; xn2 = x2;
+    };
+    void step(T *data, size_t n) { step(data, data, n); }
     //
 
     //  Set/get
@@ -53,3 +75,88 @@ class ButterworthFilter
     double a, b, c;
     //
 };
+
+
+// ButterworthFilter for a sampling rate and a cut-off frequency (CutOffNumerator/CutOffDenominator Hz)
+// fixed at compile time: the coefficients are computed by the compiler and pre-normalized by a,
+// so that step() has no division.
+template<typename T, unsigned SamplingRate, unsigned CutOffNumerator, unsigned CutOffDenominator = 1>
+class StaticButterworthFilter
+{
+  static_assert(CutOffNumerator > 0 && CutOffDenominator > 0, "cut-off frequency must be positive");
+  static_assert(2ull * CutOffNumerator < 1ull * SamplingRate * CutOffDenominator, "cut-off frequency must be below samplingRate/2");
+
+  public:
+    //  Default
+    StaticButterworthFilter() : yn0(0), yn1(0), yn2(0), xn1(0), xn2(0) {};
+    //
+
+    //  Public
+    T step(T command)
+    {
+      yn0 = g*(command + 2*xn1 + xn2) - b*yn1 - c*yn2;
+
+      yn2 = yn1;
+      yn1 = yn0;
+
+      xn2 = xn1;
+      xn1 = command;
+      return yn0;
+    };
+
+    // filters a block of n samples (in and out may be the same array), with the state kept in locals
+    void step(const T *in, T *out, size_t n)
+    {
+      T y0 = yn0, y1 = yn1, y2 = yn2;
+      T x1 = xn1, x2 = xn2;
+      for (size_t i = 0; i < n; i++)
+      {
+        const T x0 = in[i];
+        y0 = g*(x0 + 2*x1 + x2) - b*y1 - c*y2;
+        y2 = y1;
+        y1 = y0;
+        x2 = x1;
+        x1 = x0;
+        out[i] = y0;
+      }
+      yn0 = y0; yn1 = y1; yn2 = y2;
+      xn1 = x1; xn2 = x2;
+    };
+    void step(T *data, size_t n) { step(data, data, n); }
+    //
+
+    //  Set/get
+    T getValue(int index = 0)
+    {
+      if(index == 0) return yn0;
+      else if(index == 1) return yn1;
+      else if(index == 2) return yn2;
+      else return T(0);
+    }
+    T getCommand(int index)
+    {
+      if(index == 1) return xn1;
+      else if(index == 2) return xn2;
+      else return T(0);
+    }
+    //
+
+    // coefficients, same formulas as ButterworthFilter
+    static constexpr double tmp0 = 2.0 * SamplingRate * CutOffDenominator / (2 * 3.14159265 * CutOffNumerator);
+    static constexpr double a = tmp0*tmp0 + tmp0*1.4142135623730951 + 1;
+    static constexpr double g = 1 / a;
+    static constexpr double b = (2 - 2*tmp0*tmp0) / a;
+    static constexpr double c = (tmp0*tmp0 - tmp0*1.4142135623730951 + 1) / a;
+
+  protected:
+    //  Attributes
+    T yn0, yn1, yn2;
+    T xn1, xn2;
+    //
+};
+
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticButterworthFilter<T,R,N,D>::tmp0;
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticButterworthFilter<T,R,N,D>::a;
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticButterworthFilter<T,R,N,D>::g;
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticButterworthFilter<T,R,N,D>::b;
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticButterworthFilter<T,R,N,D>::c;
@@ -0,0 +1,142 @@
+#ifndef FIXEDBIQUADFILTER_H
+#define FIXEDBIQUADFILTER_H
+
+#include <limits>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "BiquadFilter.h"
+
+// Fixed-point cascade of second-order sections for integer samples, in direct form I.
+// In is the sample type and InBits the number of significant bits of the samples (10 for BITalino analog
+// channels stored in short), which sets how many guard bits the samples get inside the cascade:
+//  - coefficients are 32-bit words with 28 fractional bits (Q3.28, so that |a1| up to 2 fits);
+//  - samples are held in 32-bit words, shifted left by 27 - InBits guard bits (4 bits of headroom);
+//  - each section accumulates its five products in 64 bits, rounds once with error feedback (the
+//    remainder of the previous rounding is added back, which keeps poles close to 1 accurate),
+//    and saturates to 32 bits; outputs are rounded and saturated to the range of In.
+// All arithmetic is integer, so that for given coefficients the output is identical on every
+// architecture (right shifts of negative values are arithmetic on all supported compilers).
+template<typename In, int InBits = 8 * sizeof(In)>
+class FixedBiquadCascade
+{
+  public:
+    static const int coeffBits = 28;
+    static const int guardBits = 27 - InBits;
+    static_assert(guardBits > 0, "FixedBiquadCascade samples must have at most 26 bits");
+
+    //  Default
+    FixedBiquadCascade(const BiquadCascade<double> &design) : yn0(0)
+    {
+      for (int k = 0; k < design.getSections(); k++)
+      {
+        double b0, b1, b2, a1, a2;
+        design.getSection(k, b0, b1, b2, a1, a2);
+        Section s;
+        s.b0 = coefficient(b0);
+        s.b1 = coefficient(b1);
+        s.b2 = coefficient(b2);
+        s.a1 = coefficient(a1);
+        s.a2 = coefficient(a2);
+        sections.push_back(s);
+      }
+      reset();
+    };
+    //
+
+    //  Public
+    In step(In command)
+    {
+      int32_t x = saturate((int64_t) command * (int64_t(1) << guardBits));
+      for (size_t k = 0; k < sections.size(); k++)
+        x = sections[k].step(x);
+      yn0 = output(x);
+      return yn0;
+    };
+
+    // filters a block of n samples (in and out may be the same array), one section at a time
+    void step(const In *in, In *out, size_t n)
+    {
+      if (n == 0) return;
+      work.resize(n);
+      for (size_t i = 0; i < n; i++)
+        work[i] = saturate((int64_t) in[i] * (int64_t(1) << guardBits));
+      for (size_t k = 0; k < sections.size(); k++)
+      {
+        Section s = sections[k];   // state in locals for the block
+        for (size_t i = 0; i < n; i++)
+          work[i] = s.step(work[i]);
+        sections[k] = s;
+      }
+      for (size_t i = 0; i < n; i++)
+        out[i] = output(work[i]);
+      yn0 = out[n-1];
+    };
+    void step(In *data, size_t n) { step(data, data, n); }
+
+    void reset()
+    {
+      for (size_t k = 0; k < sections.size(); k++)
+      {
+        Section &s = sections[k];
+        s.x1 = s.x2 = s.y1 = s.y2 = 0;
+        s.err = 0;
+      }
+      yn0 = 0;
+    };
+    //
+
+    //  Set/get
+    In getValue() const { return yn0; }
+    int getSections() const { return (int) sections.size(); }
+    //
+
+  protected:
+    struct Section
+    {
+      int32_t b0, b1, b2, a1, a2;   // Q3.28 coefficients (a0 = 1)
+      int32_t x1, x2, y1, y2;       // previous inputs and outputs, with guard bits
+      int64_t err;                  // remainder of the last rounding
+
+      int32_t step(int32_t x)
+      {
+        int64_t acc = err;
+        acc += (int64_t) b0 * x + (int64_t) b1 * x1 + (int64_t) b2 * x2;
+        acc -= (int64_t) a1 * y1 + (int64_t) a2 * y2;
+        const int64_t q = acc >> coeffBits;
+        err = acc & ((int64_t(1) << coeffBits) - 1);   // acc - q * 2^coeffBits, as q rounds down
+        const int32_t y = saturate(q);
+        x2 = x1; x1 = x;
+        y2 = y1; y1 = y;
+        return y;
+      }
+    };
+
+    static int32_t coefficient(double c) { return (int32_t) llround(c * (1 << coeffBits)); }
+
+    static int32_t saturate(int64_t v)
+    {
+      if (v > std::numeric_limits<int32_t>::max()) return std::numeric_limits<int32_t>::max();
+      if (v < std::numeric_limits<int32_t>::min()) return std::numeric_limits<int32_t>::min();
+      return (int32_t) v;
+    }
+
+    // rounds a cascade value to the nearest sample value, saturated to the range of In
+    static In output(int32_t v)
+    {
+      const int64_t r = ((int64_t) v + (int64_t(1) << (guardBits - 1))) >> guardBits;
+      if (r > (int64_t) std::numeric_limits<In>::max()) return std::numeric_limits<In>::max();
+      if (r < (int64_t) std::numeric_limits<In>::min()) return std::numeric_limits<In>::min();
+      return (In) r;
+    }
+
+    //  Attributes
+    std::vector<Section> sections;
+    std::vector<int32_t> work;    // block being filtered
+    In yn0;
+    //
+};
+
+#endif // FIXEDBIQUADFILTER_H
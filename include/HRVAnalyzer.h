@@ -0,0 +1,151 @@
+#ifndef HRVANALYZER_H
+#define HRVANALYZER_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "circular_window.h"
+
+// Heart rate variability of a stream of RR intervals, updated with each beat.
+// Time-domain metrics cover the last beats intervals and cost O(1) per beat, with Running_Stats windows:
+//  - SDNN, standard deviation of the RR intervals (ms);
+//  - RMSSD, root mean square of the successive differences (ms);
+//  - pNN50, percentage of successive differences larger than 50 ms.
+// Frequency-domain metrics cover the last spectralWindow seconds: the Lomb-Scargle periodogram of the
+// (unevenly sampled) RR intervals is integrated over the LF (0.04-0.15 Hz) and HF (0.15-0.4 Hz) bands,
+// scaled so that the bands give the power of the RR intervals (ms^2). The periodogram is only computed when
+// LF or HF is queried, and at most once every cadence seconds of beats, the queries returning the last
+// values in between. It needs at least 25 s of beats (one LF period).
+// RR intervals outside 0.25-2.5 s (240-24 BPM) are taken for detection errors and ignored; the interval
+// after an ignored one is not differenced against the interval before it, which is not its predecessor.
+class HRVAnalyzer
+{
+  public:
+    //  Default
+    HRVAnalyzer(int beats = 60, double spectralWindow = 120, double cadence = 5) :
+      intervals(beats), differences(beats - 1), large(beats - 1),
+      times((uint32_t) ceil(spectralWindow / 0.25)), values((uint32_t) ceil(spectralWindow / 0.25)),
+      window(spectralWindow), cadence(cadence)
+    {
+      reset();
+    };
+    //
+
+    //  Public
+    // adds the interval rr (s) of the beat at time (s), returns false when the interval is ignored
+    bool update(double rr, double time)
+    {
+      if (rr < 0.25 || rr > 2.5)
+      {
+        rejected = true;
+        return false;
+      }
+      const double ms = 1000 * rr;
+
+      if (!intervals.empty() && !rejected)
+      {
+        const double difference = ms - intervals.back();
+        differences.push_back(difference * difference);
+        large.push_back(fabs(difference) > 50 ? 1 : 0);
+      }
+      intervals.push_back(ms);
+      rejected = false;
+
+      // spectral window, by time
+      times.push_back(time);
+      values.push_back(ms);
+      while (times.front() < time - window)
+      {
+        times.pop_front();
+        values.pop_front();
+      }
+      last = time;
+      return true;
+    };
+
+    void reset()
+    {
+      intervals.clear();
+      differences.clear();
+      large.clear();
+      times.clear();
+      values.clear();
+      rejected = false;
+      last = 0;
+      computed = -1e9;
+      lf = hf = 0;
+    };
+    //
+
+    //  Set/get
+    // number of RR intervals in the time-domain window
+    int getBeats() const { return (int) intervals.size(); }
+    double getSDNN() { return intervals.size() > 1 ? sqrt(intervals.variance()) : 0; }
+    double getRMSSD() { return differences.empty() ? 0 : sqrt(differences.mean()); }
+    double getPNN50() { return differences.empty() ? 0 : 100.0 * large.sum() / differences.size(); }
+    double getLF() { spectrum(); return lf; }
+    double getHF() { spectrum(); return hf; }
+    double getLFHF() { spectrum(); return hf > 0 ? lf / hf : 0; }
+    //
+
+  protected:
+    // LF and HF powers of the spectral window, when cadence seconds have passed since the last ones
+    void spectrum()
+    {
+      if (last - computed < cadence) return;
+      computed = last;
+      lf = hf = 0;
+
+      const uint32_t n = times.size();
+      const double span = n ? times.back() - times.front() : 0;
+      if (n < 8 || span < 25) return;
+
+      const double mean = values.mean();
+      const double pi = 3.14159265358979323846;
+      const double step = 0.005;
+      for (double f = 0.04 + step / 2; f < 0.4; f += step)
+      {
+        const double w = 2 * pi * f;
+
+        // time offset which makes the sine and cosine terms orthogonal
+        double s2 = 0, c2 = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+          s2 += sin(2 * w * times.peek(i));
+          c2 += cos(2 * w * times.peek(i));
+        }
+        const double tau = atan2(s2, c2) / (2 * w);
+
+        double yc = 0, ys = 0, cc = 0, ss = 0;
+        for (uint32_t i = 0; i < n; i++)
+        {
+          const double y = values.peek(i) - mean;
+          const double c = cos(w * (times.peek(i) - tau)), s = sin(w * (times.peek(i) - tau));
+          yc += y * c;
+          ys += y * s;
+          cc += c * c;
+          ss += s * s;
+        }
+        const double p = 0.5 * (yc * yc / cc + ys * ys / ss);
+
+        // density such that a sinusoid of amplitude A integrates to A^2/2
+        const double power = 2 * p * span / n * step;
+        if (f < 0.15) lf += power;
+        else hf += power;
+      }
+    };
+
+    //  Attributes
+    Circular_Window<double, 0, Running_Stats> intervals;    // RR intervals (ms)
+    Circular_Window<double, 0, Running_Stats> differences;  // squared successive differences (ms^2)
+    Circular_Window<long, 0, Running_Stats> large;          // successive differences above 50 ms (1 or 0)
+    Circular_Window<double> times;                          // beat times of the spectral window (s)
+    Circular_Window<double, 0, Running_Stats> values;       // RR intervals of the spectral window (ms)
+    double window, cadence;
+    bool rejected;                                          // the last interval was ignored
+    double last, computed;                                  // time of the last beat and of the last spectrum
+    double lf, hf;
+    //
+};
+
+#endif // HRVANALYZER_H
@@ -0,0 +1,283 @@
+#ifndef QRSDETECTOR_H
+#define QRSDETECTOR_H
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+
+#include "circular_window.h"
+
+// QRS detector after Pan and Tompkins, for a band-passed ECG (for instance 1-20 Hz) at any sampling rate.
+// Each sample goes through:
+//  - a five-point derivative, with taps 5 ms apart (one sample at 200 Hz and below);
+//  - squaring;
+//  - a 150 ms moving-window integration (Running_Stats mean);
+//  - peak detection: a peak of the integrated signal is confirmed when no larger value has followed it
+//    for half the integration window.
+// Peaks are classified against adaptive thresholds: the signal and noise peak levels (SPKI, NPKI) are
+// running averages of the peaks classified as QRS and as noise, and a peak is a QRS when it exceeds
+// THR1 = NPKI + (SPKI - NPKI)/4. Peaks closer than 200 ms to the previous QRS are ignored, and peaks
+// within 360 ms whose steepest slope is less than half the previous QRS's are taken for T waves.
+// When no QRS has been found for 166% of the average of the last 8 RR intervals, the largest noise
+// peak above THR1/2 since the last QRS is taken as a QRS (search-back). When no QRS has been found for
+// 2.5 s, before the first RR interval too, SPKI and NPKI are relearned from the last 1.5 s like from the
+// learning period, and at least halved, so that the detector recovers from levels learned on artifacts
+// or from a drop of the ECG amplitude.
+// The first 3 seconds initialize SPKI and NPKI, no QRS is reported during them: each level is taken from
+// the median of the three per-second maxima or means, which leaves out the start-up transient of the
+// caller's band-pass.
+// The R peak of each QRS is then located on the band-passed signal, as the largest absolute value within
+// 75 ms of the estimated position, refined to a fraction of a sample by fitting a parabola through it
+// and its two neighbours.
+// Every sample costs O(1), with no allocation after construction. The detector is an object, so that
+// several ECG channels or devices can be processed by one program.
+class QRSDetector
+{
+  public:
+    //  Default
+    QRSDetector(double samplingRate) :
+      fs(samplingRate),
+      spacing(samplingRate > 200 ? (uint32_t) lround(samplingRate / 200) : 1),
+      history(4 * spacing + 1),
+      integration(samplingRate > 20 ? (uint32_t) lround(0.15 * samplingRate) : 3),
+      rr(8),
+      hold(integration.capacity() / 2),
+      refractory((uint32_t) lround(0.2 * samplingRate)),
+      twave((uint32_t) lround(0.36 * samplingRate)),
+      delay(2 * spacing + (integration.capacity() - 1) / 2),
+      second((uint32_t) lround(samplingRate)),
+      recovery((uint32_t) lround(2.5 * samplingRate)),
+      radius((uint32_t) lround(0.075 * samplingRate)),
+      signal(hold + delay + 2 * radius + 2)
+    {
+      reset();
+    };
+    //
+
+    //  Public
+    // processes one band-passed ECG sample, returns true when a QRS has been detected
+    // (its position is then given by getBeatIndex() and getLatency())
+    bool update(double sample)
+    {
+      const uint32_t n = index++;
+      signal.push_back(sample);
+
+      // derivative, squared and integrated
+      history.push_back(sample);
+      if (!history.full()) return false;
+      const double slope = (2*sample + history.peek(3*spacing) - history.peek(spacing) - 2*history.peek(0)) / 8;
+      integration.push_back(slope * slope);
+      const double value = integration.mean();
+
+      // peak of the integrated signal: rising values start or raise a candidate,
+      // which is confirmed when no larger value has followed it for hold samples
+      bool beat = false;
+      if (value > previous && value > candidate)
+      {
+        candidate = value;
+        candidateIndex = n;
+      }
+      if (candidate > 0 && fabs(slope) > candidateSlope) candidateSlope = fabs(slope);
+      previous = value;
+
+      if (n < 3 * second)
+      {
+        // initial levels from the first 3 seconds
+        const uint32_t block = n / second;
+        learningMax[block] = std::max(learningMax[block], value);
+        learningSum[block] += value;
+        if (n + 1 == 3 * second)
+        {
+          spki = median(learningMax) / 4;
+          npki = median(learningSum) / second / 2;
+          candidate = 0;
+          candidateSlope = 0;
+          quiet = n;
+        }
+        return false;
+      }
+
+      if (candidate > 0 && n - candidateIndex >= hold)
+      {
+        beat = classify(candidate, candidateIndex, candidateSlope, n);
+        candidate = 0;
+        candidateSlope = 0;
+      }
+
+      // search-back for a missed QRS
+      if (!beat && searchPeak > 0 && !rr.empty() && n - lastPeak > 1.66 * rr.mean())
+      {
+        spki = 0.25 * searchPeak + 0.75 * spki;
+        accept(searchIndex, searchSlope, n);
+        beat = true;
+      }
+
+      // no QRS for a long time: lower the levels, relearning them from the samples after the first
+      // second (which holds the end of the last QRS)
+      if (n - quiet >= second)
+      {
+        recoveryMax = std::max(recoveryMax, value);
+        recoverySum += value;
+      }
+      if (!beat && n - quiet >= recovery)
+      {
+        spki = std::min(spki, recoveryMax / 2) / 2;
+        npki = std::min(npki, recoverySum / (recovery - second)) / 2;
+        quiet = n;
+        recoveryMax = recoverySum = 0;
+      }
+      return beat;
+    };
+
+    void reset()
+    {
+      history.clear();
+      integration.clear();
+      signal.clear();
+      rr.clear();
+      index = 0;
+      previous = candidate = candidateSlope = 0;
+      candidateIndex = 0;
+      for (int k = 0; k < 3; k++)
+        learningMax[k] = learningSum[k] = 0;
+      quiet = 0;
+      recoveryMax = recoverySum = 0;
+      spki = npki = 0;
+      searchPeak = searchSlope = 0;
+      searchIndex = 0;
+      beats = 0;
+      lastPeak = 0;
+      lastSlope = 0;
+      beatIndex = 0;
+      latency = 0;
+      rrInterval = 0;
+      peakPosition = peakInterval = 0;
+    };
+    //
+
+    //  Set/get
+    double getSamplingRate() const { return fs; }
+    // number of samples processed
+    uint32_t getSampleIndex() const { return index; }
+    // sample index of the last QRS, estimated from the integrated peak and the group delay of the
+    // derivative and the integration (the delay of the caller's band-pass is not included)
+    uint32_t getBeatIndex() const { return beatIndex; }
+    // samples between the last QRS and the sample which reported it
+    uint32_t getLatency() const { return latency; }
+    // last RR interval (samples), 0 before the second QRS
+    uint32_t getRRInterval() const { return rrInterval; }
+    // sample index of the last R peak, with a fractional part
+    double getPeakPosition() const { return peakPosition; }
+    // interval between the last two R peaks (samples, with a fractional part), 0 before the second QRS
+    double getPeakInterval() const { return peakInterval; }
+    // QRS detected so far
+    uint32_t getBeats() const { return beats; }
+    // detection threshold of the integrated signal (THR1)
+    double getThreshold() const { return npki + 0.25 * (spki - npki); }
+    //
+
+  protected:
+    // classifies a confirmed peak, returns true when it is a QRS
+    bool classify(double peak, uint32_t peakIndex, double peakSlope, uint32_t n)
+    {
+      const uint32_t distance = peakIndex - lastPeak;
+      if (beats && distance < refractory) return false;
+
+      const double thr1 = getThreshold();
+      const bool twaveSlope = beats && distance < twave && peakSlope < lastSlope / 2;
+      if (peak > thr1 && !twaveSlope)
+      {
+        spki = 0.125 * peak + 0.875 * spki;
+        accept(peakIndex, peakSlope, n);
+        return true;
+      }
+
+      npki = 0.125 * peak + 0.875 * npki;
+      if (peak > thr1 / 2 && !twaveSlope && peak > searchPeak)
+      {
+        searchPeak = peak;
+        searchIndex = peakIndex;
+        searchSlope = peakSlope;
+      }
+      return false;
+    };
+
+    // records a QRS whose integrated peak is at peakIndex, reported at sample n
+    void accept(uint32_t peakIndex, double peakSlope, uint32_t n)
+    {
+      if (beats)
+      {
+        rrInterval = peakIndex - lastPeak;
+        rr.push_back(rrInterval);
+      }
+      beats++;
+      lastPeak = peakIndex;
+      lastSlope = peakSlope;
+      beatIndex = peakIndex > delay ? peakIndex - delay : 0;
+      latency = n - beatIndex;
+      quiet = n;
+      recoveryMax = recoverySum = 0;
+      searchPeak = searchSlope = 0;
+
+      const double position = refine(n);
+      peakInterval = (beats > 1) ? position - peakPosition : 0;
+      peakPosition = position;
+    };
+
+    // median of three values
+    static double median(const double *v)
+    {
+      return std::max(std::min(v[0], v[1]), std::min(std::max(v[0], v[1]), v[2]));
+    };
+
+    // R peak around beatIndex in the band-passed signal, n being the index of the last sample
+    double refine(uint32_t n) const
+    {
+      // window of the search, limited to the samples still held (search-back can reach further)
+      const uint32_t oldest = n + 1 - signal.size();
+      const uint32_t first = std::max(beatIndex > radius ? beatIndex - radius : 0, oldest + 1);
+      const uint32_t last = std::min(beatIndex + radius, n - 1);
+      if (first > last) return beatIndex;
+
+      uint32_t best = first;
+      for (uint32_t m = first + 1; m <= last; m++)
+        if (fabs(signal.peek(m - oldest)) > fabs(signal.peek(best - oldest))) best = m;
+
+      // vertex of the parabola through the peak and its neighbours
+      const double y0 = signal.peek(best - oldest - 1), y1 = signal.peek(best - oldest), y2 = signal.peek(best - oldest + 1);
+      const double curvature = y0 - 2*y1 + y2;
+      double offset = (curvature != 0) ? (y0 - y2) / (2 * curvature) : 0;
+      if (offset > 0.5) offset = 0.5;
+      if (offset < -0.5) offset = -0.5;
+      return best + offset;
+    };
+
+    //  Attributes
+    double fs;
+    uint32_t spacing;                                      // derivative taps (samples)
+    Circular_Window<double> history;                       // derivative input
+    Circular_Window<double, 0, Running_Stats> integration; // squared derivative
+    Circular_Window<long, 0, Running_Stats> rr;            // last 8 RR intervals (samples)
+    uint32_t hold, refractory, twave, delay;               // durations (samples)
+    uint32_t second, recovery;
+    uint32_t radius;                                       // R peak search (samples)
+    Circular_Window<double> signal;                        // last band-passed samples, for the R peak
+
+    uint32_t index;
+    double previous;                                       // last integrated value
+    double candidate, candidateSlope;                      // peak being confirmed, with its steepest slope
+    uint32_t candidateIndex;
+    double learningMax[3], learningSum[3];                 // per second of the learning period
+    uint32_t quiet;                                        // last QRS or lowering of the levels
+    double recoveryMax, recoverySum;                       // from a second after quiet
+    double spki, npki;                                     // signal and noise peak levels
+    double searchPeak, searchSlope;                        // largest noise peak since the last QRS
+    uint32_t searchIndex;
+    uint32_t beats, lastPeak;
+    double lastSlope;
+    uint32_t beatIndex, latency, rrInterval;
+    double peakPosition, peakInterval;
+    //
+};
+
+#endif // QRSDETECTOR_H
@@ -0,0 +1,136 @@
+#ifndef RESPIRATIONANALYZER_H
+#define RESPIRATIONANALYZER_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "BiquadFilter.h"
+
+// Breath detector for a respiration (PZT) signal band-passed with getDesign() (0.1-1 Hz, 6-60 breaths/min).
+// Inhalation peaks and exhalation troughs are tracked with hysteresis: a peak is confirmed when the signal
+// has fallen from it by the threshold, and a trough when the signal has risen from it by the threshold.
+// The threshold is 30% of the running breath amplitude (average of the last peak-to-trough amplitudes,
+// at least minimumAmplitude), so that it follows the depth of breathing; while no breath is detected
+// for 1.5 breath periods, the running amplitude decays with a 5 s time constant, so that shallower breathing
+// is picked up again. Each confirmed peak is a breath, whose rate is given by the interval from the
+// previous peak, and whose amplitude is the height of the peak above the preceding trough; a peak before
+// the first trough has no amplitude, and is not counted.
+// While no breath is detected, the rate is limited by the time elapsed since the last one, so that it
+// falls towards 0 during apnea. Every sample costs O(1).
+class RespirationAnalyzer
+{
+  public:
+    //  Default
+    RespirationAnalyzer(double samplingRate, double minimumAmplitude = 10) :
+      design(BiquadCascade<double>::BandPass, samplingRate, 0.1, 1, 2),
+      fs(samplingRate), minimum(minimumAmplitude),
+      refractory((uint32_t) lround(samplingRate)),
+      decay(exp(-1 / (5 * samplingRate)))
+    {
+      reset();
+    };
+    //
+
+    //  Public
+    // processes one band-passed sample, returns true when a breath (inhalation peak) has been detected
+    bool update(double sample)
+    {
+      const uint32_t n = index++;
+      const double threshold = 0.3 * level > minimum ? 0.3 * level : minimum;
+      bool breath = false;
+
+      if (rising)
+      {
+        if (sample > extreme)
+        {
+          extreme = sample;
+          extremeIndex = n;
+        }
+        else if (sample < extreme - threshold)
+        {
+          // inhalation peak, a breath once a trough precedes it, unless it follows the last one by less than a second
+          if (troughFound && (!breaths || extremeIndex - lastPeak >= refractory))
+          {
+            amplitude = extreme - trough;
+            level = breaths ? 0.75 * level + 0.25 * amplitude : amplitude;
+            if (breaths) period = extremeIndex - lastPeak;
+            lastPeak = extremeIndex;
+            breaths++;
+            breath = true;
+          }
+          rising = false;
+          extreme = sample;
+        }
+      }
+      else
+      {
+        if (sample < extreme)
+          extreme = sample;
+        else if (sample > extreme + threshold)
+        {
+          // exhalation trough
+          trough = extreme;
+          troughFound = true;
+          rising = true;
+          extreme = sample;
+          extremeIndex = n;
+        }
+      }
+
+      // no breath for 1.5 periods: lower the threshold
+      if (breaths && n - lastPeak > (period ? 1.5 * period : 10 * fs))
+        level *= decay;
+
+      return breath;
+    };
+
+    void reset()
+    {
+      index = 0;
+      rising = true;
+      extreme = trough = 0;
+      troughFound = false;
+      extremeIndex = 0;
+      level = 0;
+      breaths = 0;
+      lastPeak = 0;
+      period = 0;
+      amplitude = 0;
+    };
+    //
+
+    //  Set/get
+    // band-pass filter design of the input of update()
+    const BiquadCascade<double>& getDesign() const { return design; }
+    // breaths per minute, 0 before the second breath
+    double getRate() const
+    {
+      if (!period) return 0;
+      const uint32_t elapsed = index - 1 - lastPeak;
+      return 60 * fs / (elapsed > period ? elapsed : period);
+    }
+    // peak-to-trough amplitude of the last breath (input units)
+    double getAmplitude() const { return amplitude; }
+    // breaths detected so far
+    uint32_t getBreaths() const { return breaths; }
+    //
+
+  protected:
+    //  Attributes
+    BiquadCascade<double> design;
+    double fs, minimum;
+    uint32_t refractory;          // shortest breath (samples)
+    double decay;                 // per-sample decay of level while no breath is detected
+
+    uint32_t index;
+    bool rising;                  // looking for a peak (true) or a trough (false)
+    double extreme, trough;       // current peak or trough candidate, and last trough
+    bool troughFound;             // a trough has been confirmed since reset()
+    uint32_t extremeIndex;
+    double level;                 // running breath amplitude
+    uint32_t breaths, lastPeak, period;
+    double amplitude;
+    //
+};
+
+#endif // RESPIRATIONANALYZER_H
@@ -1,3 +1,4 @@
+#include <stddef.h>
 
 template<typename T>
 class LowPassFilter
@@ -18,6 +19,19 @@ class LowPassFilter
       yn1 = yn0;
       return yn0; 
     };
+
+    // filters a block of n samples (in and out may be the same array), with the state kept in locals
+    void step(const T *in, T *out, size_t n)
+    {
+      T y = yn1;
+      for (size_t i = 0; i < n; i++)
+      {
+        y = alpha*in[i] + (1. - alpha)*y;
+        out[i] = y;
+      }
+      if (n) yn0 = yn1 = y;
+    };
+    void step(T *data, size_t n) { step(data, data, n); }
     //
 
     //  Set/get
@@ -56,6 +70,22 @@ class HighPassFilter
       xn1 = command;
       return yn0; 
     };
+
+    // filters a block of n samples (in and out may be the same array), with the state kept in locals
+    void step(const T *in, T *out, size_t n)
+    {
+      T y = yn1, x1 = xn1;
+      for (size_t i = 0; i < n; i++)
+      {
+        const T x0 = in[i];
+        y = alpha*y + alpha*(x0 - x1);
+        x1 = x0;
+        out[i] = y;
+      }
+      if (n) yn0 = yn1 = y;
+      xn1 = x1;
+    };
+    void step(T *data, size_t n) { step(data, data, n); }
     //
 
     //  Set/get
@@ -73,3 +103,118 @@ class HighPassFilter
     double alpha;
     //
 };
+
+
+// LowPassFilter and HighPassFilter for a sampling rate and a cut-off frequency
+// (CutOffNumerator/CutOffDenominator Hz) fixed at compile time: alpha is computed by the compiler.
+template<typename T, unsigned SamplingRate, unsigned CutOffNumerator, unsigned CutOffDenominator = 1>
+class StaticLowPassFilter
+{
+  static_assert(CutOffNumerator > 0 && CutOffDenominator > 0, "cut-off frequency must be positive");
+
+  public:
+    //  Default
+    StaticLowPassFilter(T initial = T(0)) : yn0(0), yn1(initial) {};
+    //
+
+    //  Public
+    T step(T command)
+    {
+      yn0 = alpha*command + beta*yn1;
+      yn1 = yn0;
+      return yn0;
+    };
+
+    // filters a block of n samples (in and out may be the same array), with the state kept in locals
+    void step(const T *in, T *out, size_t n)
+    {
+      T y = yn1;
+      for (size_t i = 0; i < n; i++)
+      {
+        y = alpha*in[i] + beta*y;
+        out[i] = y;
+      }
+      if (n) yn0 = yn1 = y;
+    };
+    void step(T *data, size_t n) { step(data, data, n); }
+    //
+
+    //  Set/get
+    T getValue(int index = 0)
+    {
+      if(index == 0) return yn0;
+      else if(index == 1) return yn1;
+      else return T(0);
+    }
+
+    // coefficients, same formulas as LowPassFilter
+    static constexpr double w = 2 * 3.14159265 * CutOffNumerator / CutOffDenominator / SamplingRate;
+    static constexpr double alpha = w / (1 + w);
+    static constexpr double beta = 1. - alpha;
+
+  protected:
+    //  Attributes
+    T yn0, yn1;
+    //
+};
+
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticLowPassFilter<T,R,N,D>::w;
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticLowPassFilter<T,R,N,D>::alpha;
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticLowPassFilter<T,R,N,D>::beta;
+
+
+template<typename T, unsigned SamplingRate, unsigned CutOffNumerator, unsigned CutOffDenominator = 1>
+class StaticHighPassFilter
+{
+  static_assert(CutOffNumerator > 0 && CutOffDenominator > 0, "cut-off frequency must be positive");
+
+  public:
+    //  Default
+    StaticHighPassFilter() : yn0(0), yn1(0), xn1(0) {};
+    //
+
+    //  Public
+    T step(T command)
+    {
+      yn0 = alpha*yn1 + alpha*(command - xn1);
+      yn1 = yn0;
+      xn1 = command;
+      return yn0;
+    };
+
+    // filters a block of n samples (in and out may be the same array), with the state kept in locals
+    void step(const T *in, T *out, size_t n)
+    {
+      T y = yn1, x1 = xn1;
+      for (size_t i = 0; i < n; i++)
+      {
+        const T x0 = in[i];
+        y = alpha*y + alpha*(x0 - x1);
+        x1 = x0;
+        out[i] = y;
+      }
+      if (n) yn0 = yn1 = y;
+      xn1 = x1;
+    };
+    void step(T *data, size_t n) { step(data, data, n); }
+    //
+
+    //  Set/get
+    T getValue(int index = 0)
+    {
+      if(index == 0) return yn0;
+      else if(index == 1) return yn1;
+      else return T(0);
+    }
+
+    // coefficient, same formula as HighPassFilter
+    static constexpr double alpha = 1 / (1 + 2 * 3.14159265 * CutOffNumerator / CutOffDenominator / SamplingRate);
+
+  protected:
+    //  Attributes
+    T yn0, yn1;
+    T xn1;
+    //
+};
+
+template<typename T, unsigned R, unsigned N, unsigned D> constexpr double StaticHighPassFilter<T,R,N,D>::alpha;
@@ -0,0 +1,107 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _ACQUISITIONHEADER_
+#define _ACQUISITIONHEADER_
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <thread>
+
+#include "bitalino.h"
+#include "circular_buffer.h"
+
+/// Acquisition thread (Linux only).
+/// A dedicated thread does nothing but read and decode frames from a %BITalino device into a bounded
+/// lock-free single-producer/single-consumer ring, so that a stall in the processing thread
+/// (filtering, LSL output, console output) never delays reading from the device.
+/// The processing thread waits on fd() (for instance in an epoll loop) and consumes frames with read().
+/// When the ring is full, new frames are dropped and counted as overflows.
+/// Each frame is stamped with the time the acquisition thread read it from the device, so that the
+/// processing thread can time events from when the frames arrived rather than from when it got to them.
+class Acquisition
+{
+public:
+   /// Ring statistics, used to size the ring.
+   struct Stats
+   {
+      int      highWater;  ///< Highest number of frames waiting in the ring
+      uint64_t overflows;  ///< Number of frames dropped because the ring was full
+      uint64_t frames;     ///< Number of frames received from the device
+   };
+
+   /// Ring capacity in frames (a power of 2): 10 s at 100 Hz, or 1 s at 1000 Hz.
+   static const uint16_t capacity = 1024;
+
+   /** Starts the acquisition thread.
+    * \param[in] dev Device, which must already be in acquisition. It must not be used by other threads
+    * until the Acquisition instance is destroyed.
+    */
+   Acquisition(BITalino &dev);
+
+   /// Stops the acquisition thread if it is still running.
+   ~Acquisition();
+
+   /// Stops the acquisition thread. The device remains in acquisition, and can then be stopped with BITalino::stop().
+   void stop(void);
+
+   /// Returns a descriptor which becomes readable when frames are available in the ring.
+   int fd(void) const { return event; }
+
+   /** Takes the frames available in the ring, without waiting.
+    * \param[out] frames Batch of frames to be filled. If the batch is empty, it is resized to 100 frames.
+    * \param[out] received If not NULL and frames are returned, time at which the last frame returned
+    * was read from the device by the acquisition thread.
+    * \return Number of frames returned in frames batch (0 if the ring is empty).
+    * \exception BITalino::Exception (Exception::CONTACTING_DEVICE) if the acquisition thread lost the device,
+    * after all frames received before the error are consumed.
+    */
+   int read(BITalino::FrameBatch &frames, std::chrono::steady_clock::time_point *received = NULL);
+
+   /// Returns the ring statistics.
+   Stats stats(void) const;
+
+private:
+   /// Frame in the ring, with the time it was read from the device.
+   struct Stamped
+   {
+      BITalino::Frame frame;
+      std::chrono::steady_clock::time_point time;
+   };
+
+   Acquisition(const Acquisition&);
+   Acquisition& operator=(const Acquisition&);
+
+   void run(void);
+   int  push(const Stamped *frames, int nFrames);
+   void signal(int fd);
+
+   BITalino &dev;
+   Circular_Buffer_SPSC<Stamped, capacity> ring;
+   std::atomic<uint64_t> received;
+   std::atomic<int>      highWater;
+   std::atomic<uint64_t> overflows;
+   std::atomic<int>      error;  ///< BITalino::Exception code raised in the acquisition thread, or 0
+   int event;        ///< eventfd signaled by the acquisition thread when frames are pushed
+   int stopEvent;    ///< eventfd signaled to stop the acquisition thread
+   std::thread thread;
+};
+
+#endif // _ACQUISITIONHEADER_
@@ -116,6 +116,7 @@
 #ifndef _BITALINOHEADER_
 #define _BITALINOHEADER_
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -125,6 +126,8 @@
 
 #endif
 
+class Transport;
+
 /// The %BITalino device class.
 class BITalino
 {
@@ -160,6 +163,34 @@ public:
    };
    typedef std::vector<Frame> VFrame;  ///< Vector of Frame's.
 
+   /// A batch of frames returned by BITalino::read(FrameBatch&).
+   /// Each field is stored in its own contiguous array (one array per analog channel),
+   /// so that a channel can be processed without walking through whole frames.
+   struct FrameBatch
+   {
+      /// Frame sequence numbers (see Frame::seq).
+      std::vector<char>          seq;
+
+      /// Digital ports states, one byte per frame: bit i is set if digital port i is at high level (see Frame::digital).
+      std::vector<unsigned char> digital;
+
+      /// Analog inputs values, one array per channel (see Frame::analog).
+      /// Only the arrays of the acquired channels are filled.
+      std::vector<short>         analog[6];
+
+      /// Resizes the batch to n frames.
+      void resize(size_t n)
+      {
+         seq.resize(n);
+         digital.resize(n);
+         for(int i = 0; i < 6; i++)
+            analog[i].resize(n);
+      }
+
+      size_t size(void) const  { return seq.size(); }   ///< Returns the number of frames in the batch.
+      bool   empty(void) const { return seq.empty(); }  ///< Returns true if the batch has no frames.
+   };
+
    /// Current device state returned by BITalino::state()
    struct State
    {
@@ -171,6 +202,15 @@ public:
       bool  digital[4];
    };
 
+   /// Link statistics returned by BITalino::linkStats()
+   struct LinkStats
+   {
+      unsigned long  resyncs,       ///< Number of times the frame stream lost synchronization (CRC check failed)
+                     skippedBytes,  ///< Number of bytes discarded while resynchronizing with the frame stream
+                     gaps,          ///< Number of valid frames received out of sequence (frames lost on the device or the link)
+                     lostFrames;    ///< Number of frames missing in these gaps (modulo 16, as given by the sequence numbers)
+   };
+
    /// %Exception class thrown from BITalino methods.
    class Exception
    {
@@ -215,6 +255,14 @@ public:
     * \exception Exception (Exception::DEVICE_NOT_FOUND) - Windows only
     */
    BITalino(const char *address);
+
+#ifndef _WIN32 // Linux or Mac OS
+   /** Connects to a %BITalino device through an already opened transport (Linux and Mac OS only).
+    * \param[in] transport Connection to the device (see Transport). The new instance takes ownership of it.
+    * \exception Exception (Exception::CONTACTING_DEVICE)
+    */
+   BITalino(Transport *transport);
+#endif
    
    /// Disconnects from a %BITalino device. If an aquisition is running, it is stopped. 
    ~BITalino();
@@ -254,6 +302,38 @@ public:
     * \exception Exception (Exception::CONTACTING_DEVICE)
     */   
    int read(VFrame &frames);
+
+   /** Reads acquisition frames from the device into a structure-of-arrays batch.
+    * This method behaves as read(VFrame &) but fills one contiguous array per channel.
+    * \param[out] frames Batch of frames to be filled. If the batch is empty, it is resized to 100 frames.
+    * \return Number of frames returned in frames batch. If a timeout occurred, this number is less than the frames batch size.
+    * \remarks This method must be called only during an acquisition.
+    * \exception Exception (Exception::DEVICE_NOT_IN_ACQUISITION)
+    * \exception Exception (Exception::CONTACTING_DEVICE)
+    */
+   int read(FrameBatch &frames);
+
+   /** Reads the acquisition frames already received from the device, without waiting.
+    * This method is meant to be called when the descriptor returned by BITalino::fileDescriptor()
+    * becomes readable in an event loop. As data is buffered internally, it should be called again
+    * while it fills the whole batch.
+    * \param[out] frames Batch of frames to be filled. If the batch is empty, it is resized to 100 frames.
+    * \return Number of frames returned in frames batch (0 if no complete frame is available yet).
+    * \remarks This method must be called only during an acquisition.
+    * \exception Exception (Exception::DEVICE_NOT_IN_ACQUISITION)
+    * \exception Exception (Exception::CONTACTING_DEVICE)
+    */
+   int readAvailable(FrameBatch &frames);
+
+   /** Reads the acquisition frames already received from the device into a vector of frames, without waiting.
+    * This method behaves as readAvailable(FrameBatch &) but fills a vector of frames.
+    * \param[out] frames Vector of frames to be filled. If the vector is empty, it is resized to 100 frames.
+    * \return Number of frames returned in frames vector (0 if no complete frame is available yet).
+    * \remarks This method must be called only during an acquisition.
+    * \exception Exception (Exception::DEVICE_NOT_IN_ACQUISITION)
+    * \exception Exception (Exception::CONTACTING_DEVICE)
+    */
+   int readAvailable(VFrame &frames);
    
    /** Sets the battery voltage threshold for the low-battery LED.
     * \param[in] value Battery voltage threshold. Default value is 0.
@@ -299,20 +379,61 @@ public:
     */
    State state(void);
 
+   /** Returns the link statistics accumulated since the connection was established.
+    * These counters show how much data was lost to link noise.
+    */
+   LinkStats linkStats(void) const;
+
+#ifndef _WIN32 // Linux or Mac OS
+   /** Returns a descriptor which becomes readable when data arrives from the device (Linux and Mac OS only).
+    * It can be registered with select(), poll() or an epoll loop, together with other event sources.
+    */
+   int fileDescriptor(void) const;
+#endif
+
 private:
+   void checkVersion(void);
+   int  readFrames(VFrame &frames, bool wait);
+   int  readBatch(FrameBatch &frames, bool wait);
+   int  nextFrames(int maxFrames, bool wait);
+   bool resync(int nBytes);
    void send(char cmd);
    int  recv(void *data, int nbyttoread);
+   int  recvAvailable(void *data, int maxbyttoread, bool wait);
    void close(void);
 
+   typedef int  (*FrameChecker)(const unsigned char *data, int nFrames);
+   typedef void (*FrameUnpacker)(const unsigned char *data, int nFrames, Frame *frames);
+   typedef void (*BatchUnpacker)(const unsigned char *data, int nFrames, FrameBatch &frames, int offset);
+
    char nChannels;
    bool isBitalino2;
+
+   /// Frame size and decoding functions specialized for the number of acquired channels (set in BITalino::start()).
+   int            frameSize;
+   FrameChecker   frameCheck;
+   FrameUnpacker  frameUnpack;
+   BatchUnpacker  batchUnpack;
+
+   /// Staging buffer for BITalino::read(): all bytes available from the device are read at once,
+   /// and a partial frame left at the end is carried over to the next call.
+   unsigned char rxBuf[2048];
+   int rxBegin, rxEnd;  ///< Unconsumed data is rxBuf[rxBegin...rxEnd-1].
+   bool synced;         ///< False while searching for the next valid frame after a CRC failure.
+   int  nextSeq;        ///< Expected sequence number of the next frame (-1 if unknown).
+   LinkStats stats;
+
+   /// Command scheduler: the device may miss a command sent less than commandSpacing milliseconds
+   /// after the previous one was sent, even if the device has already answered it.
+   static const int commandSpacing = 150;
+   std::chrono::steady_clock::time_point lastCommand;   ///< Time of the last command sent.
+   bool commandSent;      ///< False until the first command is sent.
 #ifdef _WIN32
    SOCKET	fd;
    timeval  readtimeout;
    HANDLE   hCom;
 #else // Linux or Mac OS
-   int      fd;
-   bool     isTTY;
+   Transport *transport;
 #endif
 };
 
@@ -39,13 +39,31 @@
 #define CIRCULAR_BUFFER_H
 // #include <ArduinoSTL.h>
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <type_traits>
+#include <vector>
+
+#include "circular_buffer_policies.h"
+
+// Zero-copy view of buffered values: first[0...first_length-1] followed by second[0...second_length-1],
+// oldest first. The view stays valid until the values are consumed or overwritten.
+template<typename T>
+struct Circular_Spans {
+        T *first;
+        uint16_t first_length;
+        T *second;
+        uint16_t second_length;
+        uint16_t size() const { return first_length + second_length; }
+};
 
-template<typename T, uint16_t _size, uint16_t multi = 0>
-class Circular_Buffer {
+template<typename T, uint16_t _size, uint16_t multi = 0, template<typename, uint32_t> class... Policies>
+class Circular_Buffer : public Policies<T,_size>... {
     public:
+        Circular_Buffer() { policies_init(); }
 
         void push_back(T value) { return write(value); }
         void push_front(T value);
@@ -62,8 +80,10 @@ class Circular_Buffer {
         T peek_front(T *buffer, uint16_t length, uint32_t entry = 0);
         T read(T *buffer, uint16_t length) { return readBytes(buffer,length); }
         T readBytes(T *buffer, uint16_t length);
+        Circular_Spans<T> spans();
+        void consume(uint16_t length);
         void flush() { clear(); }
-        void clear() { head = tail = _available = 0; }
+        void clear() { head = tail = _available = 0; policies_reset(); }
         void print(const char *p);
         void println(const char *p);
         uint16_t size() { return _available; }
@@ -96,17 +116,47 @@ class Circular_Buffer {
 
     protected:
     private:
+        // policy notifications (see circular_buffer_policies.h)
+        void policies_init() { int expand[] = { 0, (Policies<T,_size>::init(_size), 0)... }; (void)expand; }
+        void policies_push(T value) { int expand[] = { 0, (Policies<T,_size>::on_push_back(value), 0)... }; (void)expand; (void)value; }
+        void policies_pop(T value) { int expand[] = { 0, (Policies<T,_size>::on_pop_front(value), 0)... }; (void)expand; (void)value; }
+        void policies_reset() { int expand[] = { 0, (Policies<T,_size>::reset(), 0)... }; (void)expand; }
+        void policies_rebuild();
+        template<template<typename, uint32_t> class Policy> struct has_policy : std::is_base_of<Policy<T,_size>, Circular_Buffer> { };
+
+        T max(std::true_type) { return Windowed_Extremum<T,_size>::window_max(); }
+        T max(std::false_type);
+        T min(std::true_type) { return Windowed_Extremum<T,_size>::window_min(); }
+        T min(std::false_type);
+        T sum(std::true_type) { return Running_Stats<T,_size>::window_sum(); }
+        T sum(std::false_type);
+        T average(std::true_type) { return Running_Stats<T,_size>::window_mean(); }
+        T average(std::false_type) { return sum()/_available; }
+        T variance(std::true_type) { return Running_Stats<T,_size>::window_variance(); }
+        T variance(std::false_type);
+        T median(bool override, std::true_type) { (void)override; return Sliding_Median<T,_size>::window_median(); }
+        T median(bool override, std::false_type);
+        T* linearize();
+
         volatile uint16_t head = 0;
         volatile uint16_t tail = 0;
         volatile uint16_t _available = 0;
 
         T _cbuf[_size];
         T _cabuf[_size][multi+2];
+        std::vector<T> _scratch; // median() work area, allocated on first use
 };
 
 
-template<typename T, uint16_t _size, uint16_t multi>
-bool Circular_Buffer<T,_size,multi>::remove(uint16_t pos) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::policies_rebuild() {
+  if ( multi || !sizeof...(Policies) ) return;
+  policies_reset();
+  for ( uint16_t i = 0; i < _available; i++ ) policies_push(_cbuf[((head+i)&(_size-1))]);
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+bool Circular_Buffer<T,_size,multi,Policies...>::remove(uint16_t pos) {
   if ( multi ) {
     if ( pos >= _size ) return 0;
 
@@ -134,8 +184,8 @@ bool Circular_Buffer<T,_size,multi>::remove(uint16_t pos) {
 
 
 
-template<typename T, uint16_t _size, uint16_t multi>
-bool Circular_Buffer<T, _size, multi>::findRemove(T *buffer, uint16_t length, int pos1, int pos2, int pos3, int pos4, int pos5) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+bool Circular_Buffer<T, _size, multi,Policies...>::findRemove(T *buffer, uint16_t length, int pos1, int pos2, int pos3, int pos4, int pos5) {
   uint8_t input_count = 3;
   int32_t found = -1;
   if ( pos4 != -1 ) input_count = 4;
@@ -186,8 +236,8 @@ bool Circular_Buffer<T, _size, multi>::findRemove(T *buffer, uint16_t length, in
 
 
 
-template<typename T, uint16_t _size, uint16_t multi>
-bool Circular_Buffer<T, _size, multi>::find(T *buffer, uint16_t length, int pos1, int pos2, int pos3, int pos4, int pos5) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+bool Circular_Buffer<T, _size, multi,Policies...>::find(T *buffer, uint16_t length, int pos1, int pos2, int pos3, int pos4, int pos5) {
   uint8_t input_count = 3;
   bool found = 0;
   if ( pos4 != -1 ) input_count = 4;
@@ -226,8 +276,8 @@ bool Circular_Buffer<T, _size, multi>::find(T *buffer, uint16_t length, int pos1
 }
 
 
-template<typename T, uint16_t _size, uint16_t multi>
-bool Circular_Buffer<T, _size, multi>::replace(T *buffer, uint16_t length, int pos1, int pos2, int pos3, int pos4, int pos5) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+bool Circular_Buffer<T, _size, multi,Policies...>::replace(T *buffer, uint16_t length, int pos1, int pos2, int pos3, int pos4, int pos5) {
   uint8_t input_count = 3;
   bool found = 0;
   if ( pos4 != -1 ) input_count = 4;
@@ -273,8 +323,8 @@ bool Circular_Buffer<T, _size, multi>::replace(T *buffer, uint16_t length, int p
 
 
 
-template<typename T, uint16_t _size, uint16_t multi>
-bool Circular_Buffer<T,_size,multi>::isEqual(const T *buffer) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+bool Circular_Buffer<T,_size,multi,Policies...>::isEqual(const T *buffer) {
   if ( multi ) {
     bool success = 1;
     for ( uint16_t j = 0; j < _available; j++ ) {
@@ -296,21 +346,21 @@ bool Circular_Buffer<T,_size,multi>::isEqual(const T *buffer) {
 
 
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::print(const char *p) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::print(const char *p) {
   if ( multi ) return;
   write((T*)p,strlen(p));
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::println(const char *p) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::println(const char *p) {
   if ( multi ) return;
   write((T*)p,strlen(p));
   write('\n');
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::push_front(const T *buffer, uint16_t length) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::push_front(const T *buffer, uint16_t length) {
   if ( multi ) {
     if ( tail == (head ^ _size) ) tail = ((tail - 1)&(2*_size-1));
     head = ((head - 1)&(2*_size-1));
@@ -324,26 +374,29 @@ void Circular_Buffer<T,_size,multi>::push_front(const T *buffer, uint16_t length
   push_front(buffer[0]);
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::pop_back() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::pop_back() {
   if ( _available ) {
     if ( _available ) _available--;
     tail = ((tail - 1)&(2*_size-1));
-    return _cbuf[((tail)&(_size-1))];
+    T value = _cbuf[((tail)&(_size-1))];
+    policies_rebuild();
+    return value;
   }
   return -1;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::push_front(T value) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::push_front(T value) {
   if ( multi ) return;
   head = ((head - 1)&(2*_size-1));
   _cbuf[((head)&(_size-1))] = value;
   if ( _available < _size ) _available++;
+  policies_rebuild();
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::write(const T *buffer, uint16_t length) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::write(const T *buffer, uint16_t length) {
   if ( multi ) {
     _cabuf[((tail)&(_size-1))][0] = length & 0xFF00;
     _cabuf[((tail)&(_size-1))][1] = length & 0xFF;
@@ -353,6 +406,10 @@ void Circular_Buffer<T,_size,multi>::write(const T *buffer, uint16_t length) {
     if ( _available < _size ) _available++;
     return;
   }
+  if ( sizeof...(Policies) ) { // policies must see each value
+    for ( uint16_t i = 0; i < length; i++ ) write(buffer[i]);
+    return;
+  }
   if ( ( _available += length ) >= _size ) _available = _size;
   if ( length < ( _size - tail ) ) {
     memmove(_cbuf+tail,buffer,length*sizeof(T));
@@ -361,17 +418,19 @@ void Circular_Buffer<T,_size,multi>::write(const T *buffer, uint16_t length) {
   else for ( uint16_t i = 0; i < length; i++ ) write(buffer[i]);
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::write(T value) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::write(T value) {
   if ( multi ) return;
+  if ( tail == ((head ^ _size)) ) policies_pop(_cbuf[((head)&(_size-1))]); // oldest value is overwritten
   if ( _available < _size ) _available++;
   _cbuf[((tail)&(_size-1))] = value;
   if ( tail == ((head ^ _size)) ) head = ((head + 1)&(2*_size-1));
   tail = ((tail + 1)&(2*_size-1));
+  policies_push(value);
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::list() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::list() {
   if ( multi ) {
     if ( !size() ) {
         printf("There are no queues available..."); printf("\n"); return 0;
@@ -444,36 +503,49 @@ T Circular_Buffer<T,_size,multi>::list() {
   return _available;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::read() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::read() {
   if ( multi ) {
     head = ((head + 1)&(2*_size-1));
     if ( _available ) _available--;
     return 0;
   }
-  if ( _available ) _available--;
   T value = _cbuf[((head)&(_size-1))];
+  if ( _available ) {
+    _available--;
+    policies_pop(value);
+  }
   head = ((head + 1)&(2*_size-1));
   return value;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::sum() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::sum() {
   if ( multi || !_available ) return 0;
+  return sum(has_policy<Running_Stats>());
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::sum(std::false_type) {
   T value = 0;
   for ( uint16_t i = 0; i < _available; i++ ) value += _cbuf[((head+i)&(_size-1))];
   return value;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::average() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::average() {
   if ( multi || !_available ) return 0;
-  return sum()/_available;
+  return average(has_policy<Running_Stats>());
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::variance() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::variance() {
   if ( multi || !_available ) return 0;
+  return variance(has_policy<Running_Stats>());
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::variance(std::false_type) {
   T _mean = average();
   T value = 0;
   for ( uint16_t i = 0; i < _available; i++ ) {
@@ -483,111 +555,150 @@ T Circular_Buffer<T,_size,multi>::variance() {
   return value;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::deviation() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::deviation() {
   if ( multi || !_available ) return 0;
   return sqrt(variance());
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::peek(uint16_t pos) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::peek(uint16_t pos) {
   if ( multi ) return 0;
   if ( pos > _size ) return 0;
   return _cbuf[((head+pos)&(_size-1))];
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::sort_ascending() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::sort_ascending() {
   if ( multi || !_available ) return;
-  T buffer[_available];
-  for ( uint16_t i = 0; i < _available; i++ ) buffer[i] = _cbuf[((head+i)&(_size-1))];
-  std::sort(&buffer[0], &buffer[_available]); // sort ascending
-  for ( uint16_t i = 0; i < _available; i++ ) _cbuf[((head+i)&(_size-1))] = buffer[i];
+  T *buffer = linearize();
+  std::sort(buffer, buffer + _available); // sort ascending in place
+  policies_rebuild();
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-void Circular_Buffer<T,_size,multi>::sort_descending() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::sort_descending() {
   if ( multi || !_available ) return;
-  sort_ascending();
-  T buffer[_available];
-  for ( uint16_t i = 0; i < _available; i++ ) buffer[i] = _cbuf[((head+i)&(_size-1))];
-  std::reverse(&buffer[0], &buffer[_available]); // sort descending
-  for ( uint16_t i = 0; i < _available; i++ ) _cbuf[((head+i)&(_size-1))] = buffer[i];
+  T *buffer = linearize();
+  std::sort(buffer, buffer + _available, std::greater<T>()); // sort descending in place
+  policies_rebuild();
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T* Circular_Buffer<T,_size,multi,Policies...>::linearize() { // moves the window to _cbuf[0..._available-1]
+  const uint16_t pos = ((head)&(_size-1));
+  if ( pos + _available > _size ) std::rotate(_cbuf, _cbuf + pos, _cbuf + _size); // window wraps around
+  else if ( pos ) std::copy(_cbuf + pos, _cbuf + pos + _available, _cbuf);
+  head = 0;
+  tail = _available;
+  return _cbuf;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::median(bool override) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::median(bool override) {
   if ( multi || !_available ) return 0;
-  if ( override ) sort_ascending();
-  else {
-    T buffer[_available];
-    for ( uint16_t i = 0; i < _available; i++ ) buffer[i] = _cbuf[((head+i)&(_size-1))];
-    std::sort(&buffer[0], &buffer[_available]); // sort ascending
-  }
-  if ( !(_available % 2) ) {
-    return ( _cbuf[((head+((_available/2)-1))&(_size-1))]  +  _cbuf[((head+(_available/2))&(_size-1))] ) /2;
+  return median(override, has_policy<Sliding_Median>()); // the policy never reorders the buffer
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::median(bool override, std::false_type) {
+  if ( override ) { // sort the buffer itself and read the middle
+    sort_ascending();
+    if ( !(_available % 2) ) return ( _cbuf[(_available/2)-1] + _cbuf[_available/2] ) /2;
+    return _cbuf[_available/2];
   }
-  else return _cbuf[((head+((_available/2)))&(_size-1))];  
-  return 0;
+  // select the middle of a copy, leaving the buffer order untouched
+  const Circular_Spans<T> view = spans();
+  if ( _scratch.capacity() < _size ) _scratch.reserve(_size);
+  _scratch.assign(view.first, view.first + view.first_length);
+  _scratch.insert(_scratch.end(), view.second, view.second + view.second_length);
+  const typename std::vector<T>::iterator mid = _scratch.begin() + _available/2;
+  std::nth_element(_scratch.begin(), mid, _scratch.end());
+  if ( !(_available % 2) ) return ( *std::max_element(_scratch.begin(), mid) + *mid ) /2; // lower middle is the largest value below mid
+  return *mid;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::max() {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::max() {
   if ( multi || !_available ) return 0;
-  T buffer[_available];
-  //T buffer[128];
-  for ( uint16_t i = 0; i < _available; i++ ) buffer[i] = _cbuf[((head+i)&(_size-1))];
-  std::sort(&buffer[0], &buffer[_available]); // sort ascending
-  return buffer[_available-1];
-}
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::min() {
+  return max(has_policy<Windowed_Extremum>());
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::max(std::false_type) {
+  const Circular_Spans<T> view = spans();
+  T value = *std::max_element(view.first, view.first + view.first_length);
+  if ( view.second_length ) value = std::max(value, *std::max_element(view.second, view.second + view.second_length));
+  return value;
+}
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::min() {
   if ( multi || !_available ) return 0;
-  T buffer[_available];
-  for ( uint16_t i = 0; i < _available; i++ ) buffer[i] = _cbuf[((head+i)&(_size-1))];
-  std::sort(&buffer[0], &buffer[_available]); // sort ascending
-  return buffer[0];
+  return min(has_policy<Windowed_Extremum>());
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::peekBytes(T *buffer, uint16_t length) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::min(std::false_type) {
+  const Circular_Spans<T> view = spans();
+  T value = *std::min_element(view.first, view.first + view.first_length);
+  if ( view.second_length ) value = std::min(value, *std::min_element(view.second, view.second + view.second_length));
+  return value;
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::peekBytes(T *buffer, uint16_t length) {
   if ( multi ) return 0;
-  uint16_t _count;
-  ( _available < length ) ? _count = _available : _count = length;
-  if ( _count < ( _size - head ) ) memmove(buffer,_cbuf,_count*sizeof(T));
-  else for ( uint16_t i = 0; i < _count; i++ ) buffer[i] = peek(i);
+  const Circular_Spans<T> view = spans();
+  const uint16_t _count = ( view.size() < length ) ? view.size() : length;
+  const uint16_t first = ( _count < view.first_length ) ? _count : view.first_length;
+  std::copy(view.first, view.first + first, buffer);
+  std::copy(view.second, view.second + _count - first, buffer + first);
   return _count;
 }
 
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::peek_front(T *buffer, uint16_t length, uint32_t entry) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::peek_front(T *buffer, uint16_t length, uint32_t entry) {
   if ( multi ) {
     memmove(&buffer[0],&_cabuf[((head+entry)&(_size-1))][2],length*sizeof(T)); // update CA buffer
     return 0;
   }
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::readBytes(T *buffer, uint16_t length) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::readBytes(T *buffer, uint16_t length) {
   if ( multi ) {
     memmove(&buffer[0],&_cabuf[((head)&(_size-1))][2],length*sizeof(T)); // update CA buffer
     read();
     return 0;
   }
-  uint16_t _count;
-  ( _available < length ) ? _count = _available : _count = length; // memmove if aligned
-  if ( _count < ( _size - head ) ) {
-    _available -= length;
-    memmove(buffer,_cbuf,_count*sizeof(T));
-    head = ((head + _count)&(2*_size-1));
-  }
-  else for ( uint16_t i = 0; i < _count; i++ ) buffer[i] = read(); // if buffer rollover
+  const uint16_t _count = peekBytes(buffer, length);
+  consume(_count);
   return _count;
 }
 
-template<typename T, uint16_t _size, uint16_t multi>
-T Circular_Buffer<T,_size,multi>::pop_back(T *buffer, uint16_t length) {
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+Circular_Spans<T> Circular_Buffer<T,_size,multi,Policies...>::spans() {
+  Circular_Spans<T> view = { _cbuf + ((head)&(_size-1)), 0, _cbuf, 0 };
+  if ( multi ) return view; // entries are not contiguous values
+  const uint16_t pos = ((head)&(_size-1));
+  view.first_length = ( _available < _size - pos ) ? _available : (uint16_t)(_size - pos);
+  view.second_length = _available - view.first_length;
+  return view;
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+void Circular_Buffer<T,_size,multi,Policies...>::consume(uint16_t length) {
+  if ( length > _available ) length = _available;
+  if ( sizeof...(Policies) ) { // policies must see each value leaving the window
+    for ( uint16_t i = 0; i < length; i++ ) policies_pop(_cbuf[((head+i)&(_size-1))]);
+  }
+  head = ((head + length)&(2*_size-1));
+  _available -= length;
+}
+
+template<typename T, uint16_t _size, uint16_t multi, template<typename, uint32_t> class... Policies>
+T Circular_Buffer<T,_size,multi,Policies...>::pop_back(T *buffer, uint16_t length) {
   if ( multi ) {
     memmove(&buffer[0],&_cabuf[((tail-1)&(_size-1))][2],length*sizeof(T));
     tail = (tail - 1)&(2*_size-1);
@@ -596,4 +707,102 @@ T Circular_Buffer<T,_size,multi>::pop_back(T *buffer, uint16_t length) {
   }
 }
 
+
+// Lock-free single-producer/single-consumer variant, for handing data between two threads.
+// One thread only writes (push_back/write) and the other only reads (pop_front/read).
+// head and tail are free-running std::atomic indices published with release stores and observed with
+// acquire loads, each kept on its own cache line together with the other side's last seen index,
+// so that the producer and the consumer do not invalidate each other's cache lines on every call.
+// The lines are aligned with alignas, which also keeps the values off them; heap allocations keep
+// this alignment only with C++17 aligned new.
+// Writes never block nor overwrite: when the buffer is full, the values which do not fit are rejected.
+// The consumer may also work in place on spans() and release the values with consume(), which must not
+// exceed the size of the view.
+// _size must be a power of 2.
+
+template<typename T, uint16_t _size>
+class Circular_Buffer_SPSC {
+    public:
+        Circular_Buffer_SPSC() : head(0), tail_cache(0), tail(0), head_cache(0) { }
+
+        // producer side
+        bool push_back(const T &value) { return write(&value, 1) == 1; }
+        uint16_t write(const T *buffer, uint16_t length);
+
+        // consumer side
+        bool pop_front(T &value) { return read(&value, 1) == 1; }
+        uint16_t read(T *buffer, uint16_t length);
+        Circular_Spans<T> spans();
+        void consume(uint16_t length) { head.store(head.load(std::memory_order_relaxed) + length, std::memory_order_release); }
+
+        // either side (the value may be outdated as soon as it is returned)
+        uint16_t size() const { return (uint16_t)(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire)); }
+        uint16_t available() const { return size(); }
+        uint16_t capacity() const { return _size; }
+        bool empty() const { return size() == 0; }
+        bool full() const { return size() == _size; }
+
+    private:
+        static_assert(_size && !(_size & (_size - 1)), "Circular_Buffer_SPSC size must be a power of 2");
+
+        static const int cache_line = 64;
+
+        // consumer cache line
+        alignas(cache_line) std::atomic<uint32_t> head;   // index of the next value to read, written by the consumer only
+        uint32_t tail_cache;                              // last tail seen by the consumer
+
+        // producer cache line
+        alignas(cache_line) std::atomic<uint32_t> tail;   // index of the next value to write, written by the producer only
+        uint32_t head_cache;                              // last head seen by the producer
+
+        alignas(cache_line) T _cbuf[_size];
+};
+
+
+template<typename T, uint16_t _size>
+uint16_t Circular_Buffer_SPSC<T,_size>::write(const T *buffer, uint16_t length) {
+  const uint32_t t = tail.load(std::memory_order_relaxed);
+  if ( _size - (t - head_cache) < length ) head_cache = head.load(std::memory_order_acquire); // refresh only if needed
+  const uint32_t _free = _size - (t - head_cache);
+  const uint16_t _count = ( length < _free ) ? length : (uint16_t)_free;
+
+  // copy in at most two contiguous segments
+  const uint16_t pos = t & (_size-1);
+  const uint16_t first = ( _count < _size - pos ) ? _count : (uint16_t)(_size - pos);
+  std::copy(buffer, buffer + first, _cbuf + pos);
+  std::copy(buffer + first, buffer + _count, _cbuf);
+
+  tail.store(t + _count, std::memory_order_release);
+  return _count;
+}
+
+template<typename T, uint16_t _size>
+uint16_t Circular_Buffer_SPSC<T,_size>::read(T *buffer, uint16_t length) {
+  const uint32_t h = head.load(std::memory_order_relaxed);
+  if ( tail_cache - h < length ) tail_cache = tail.load(std::memory_order_acquire); // refresh only if needed
+  const uint32_t _used = tail_cache - h;
+  const uint16_t _count = ( length < _used ) ? length : (uint16_t)_used;
+
+  // copy out at most two contiguous segments
+  const uint16_t pos = h & (_size-1);
+  const uint16_t first = ( _count < _size - pos ) ? _count : (uint16_t)(_size - pos);
+  std::copy(_cbuf + pos, _cbuf + pos + first, buffer);
+  std::copy(_cbuf, _cbuf + _count - first, buffer + first);
+
+  head.store(h + _count, std::memory_order_release);
+  return _count;
+}
+
+template<typename T, uint16_t _size>
+Circular_Spans<T> Circular_Buffer_SPSC<T,_size>::spans() {
+  const uint32_t h = head.load(std::memory_order_relaxed);
+  tail_cache = tail.load(std::memory_order_acquire);
+  const uint16_t _used = (uint16_t)(tail_cache - h);
+  const uint16_t pos = h & (_size-1);
+  const uint16_t first = ( _used < _size - pos ) ? _used : (uint16_t)(_size - pos);
+  Circular_Spans<T> view = { _cbuf + pos, first, _cbuf, (uint16_t)(_used - first) };
+  return view;
+}
+
+
 #endif // Circular_Buffer_H
@@ -0,0 +1,310 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Optional policies for Circular_Buffer (see circular_buffer.h) and Circular_Window (see circular_window.h).
+// A policy is a class template taking the buffer element type and size, listed after the buffer's
+// size parameters, for instance Circular_Buffer<long, 32, 0, Windowed_Extremum> or
+// Circular_Window<long, 250, Windowed_Extremum>.
+// The buffer derives from its policies, sizes them for its capacity (init), and notifies them of every
+// value entering (on_push_back) or leaving (on_pop_front) the window, so that they can maintain
+// statistics incrementally.
+// After operations which reorder or edit the window in the middle (push_front, pop_back, remove, sorts),
+// the buffer resets its policies and feeds them the whole window again.
+// Queries such as max() and min() use a policy when the buffer has it, and fall back to scanning otherwise.
+
+#ifndef CIRCULAR_BUFFER_POLICIES_H
+#define CIRCULAR_BUFFER_POLICIES_H
+
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+// Smallest power of 2 not less than n.
+constexpr uint32_t circular_pow2(uint32_t n, uint32_t p = 1) { return p >= n ? p : circular_pow2(n, p*2); }
+
+// Policy storage holding at least _size entries, indexed modulo a power of 2 (so that free-running
+// sequence numbers can be used as indices). The size is fixed at compile time, or set by init()
+// when _size is 0 (buffers with run-time capacity).
+template<typename X, uint32_t _size>
+class Policy_Ring {
+    public:
+        void init(uint32_t capacity) { (void)capacity; }
+        X& operator[](uint32_t i) { return data[i & (N-1)]; }
+        const X& operator[](uint32_t i) const { return data[i & (N-1)]; }
+
+    private:
+        static const uint32_t N = circular_pow2(_size);
+        X data[N];
+};
+
+template<typename X>
+class Policy_Ring<X, 0> {
+    public:
+        Policy_Ring() : mask(0), data(1) { }
+        void init(uint32_t capacity) { data.assign(circular_pow2(capacity), X()); mask = (uint32_t) data.size() - 1; }
+        X& operator[](uint32_t i) { return data[i & mask]; }
+        const X& operator[](uint32_t i) const { return data[i & mask]; }
+
+    private:
+        uint32_t mask;
+        std::vector<X> data;
+};
+
+// Sliding window maximum and minimum in amortized O(1) per value.
+// Two monotonic deques hold the candidates for the maximum (decreasing values) and the minimum
+// (increasing values) with their sequence numbers. A pushed value removes the candidates it dominates,
+// and a value leaving the window is removed from the front of a deque if it is still there.
+// Each deque never holds more entries than the window, so both are stored in policy rings.
+
+template<typename T, uint32_t _size>
+class Windowed_Extremum {
+    public:
+        T window_max() const { return max_val[max_head]; }
+        T window_min() const { return min_val[min_head]; }
+
+    protected:
+        Windowed_Extremum() { reset(); }
+        void init(uint32_t capacity) { max_val.init(capacity); min_val.init(capacity); max_seq.init(capacity); min_seq.init(capacity); }
+        void on_push_back(T value);
+        void on_pop_front(T value);
+        void reset() { pushed = popped = max_head = max_tail = min_head = min_tail = 0; }
+
+    private:
+        uint32_t pushed, popped;      // sequence numbers of the next value pushed and of the next value popped
+        uint32_t max_head, max_tail;  // max deque is max_val/max_seq[max_head...max_tail-1]
+        uint32_t min_head, min_tail;  // min deque is min_val/min_seq[min_head...min_tail-1]
+        Policy_Ring<T,_size> max_val, min_val;
+        Policy_Ring<uint32_t,_size> max_seq, min_seq;
+};
+
+
+template<typename T, uint32_t _size>
+void Windowed_Extremum<T,_size>::on_push_back(T value) {
+  while ( max_tail != max_head && !(value < max_val[max_tail-1]) ) max_tail--;
+  max_val[max_tail] = value;
+  max_seq[max_tail] = pushed;
+  max_tail++;
+
+  while ( min_tail != min_head && !(min_val[min_tail-1] < value) ) min_tail--;
+  min_val[min_tail] = value;
+  min_seq[min_tail] = pushed;
+  min_tail++;
+
+  pushed++;
+}
+
+template<typename T, uint32_t _size>
+void Windowed_Extremum<T,_size>::on_pop_front(T value) {
+  (void)value;
+  if ( max_head != max_tail && max_seq[max_head] == popped ) max_head++;
+  if ( min_head != min_tail && min_seq[min_head] == popped ) min_head++;
+  popped++;
+}
+
+// Running sum, mean and variance in O(1) per value and per query.
+// For integer types, the policy keeps exact 64-bit sums of the values and of their squares, so it never
+// drifts nor overflows where the buffer's own T accumulator would, and it returns the same values as
+// the scanning path (truncated mean, population variance around the truncated mean).
+// For floating point types, it keeps a Welford mean and sum of squared deviations, updated in both
+// directions as values enter and leave the window.
+
+template<typename T, uint32_t _size>
+class Running_Stats {
+    public:
+        T window_sum() const { return window_sum(std::is_integral<T>()); }
+        T window_mean() const { return window_mean(std::is_integral<T>()); }
+        T window_variance() const { return window_variance(std::is_integral<T>()); }
+
+    protected:
+        Running_Stats() { reset(); }
+        void init(uint32_t capacity) { (void)capacity; }
+        void on_push_back(T value) { add(value, std::is_integral<T>()); }
+        void on_pop_front(T value) { remove(value, std::is_integral<T>()); }
+        void reset() { count = 0; isum = isum2 = 0; mean = m2 = 0; }
+
+    private:
+        void add(T value, std::true_type) { count++; isum += value; isum2 += (int64_t)value * value; }
+        void remove(T value, std::true_type) { count--; isum -= value; isum2 -= (int64_t)value * value; }
+        void add(T value, std::false_type);
+        void remove(T value, std::false_type);
+
+        T window_sum(std::true_type) const { return (T)isum; }
+        T window_sum(std::false_type) const { return (T)(mean * count); }
+        T window_mean(std::true_type) const { return (T)(isum / (int64_t)count); }
+        T window_mean(std::false_type) const { return (T)mean; }
+        T window_variance(std::true_type) const;
+        T window_variance(std::false_type) const { return (T)(m2 / count); }
+
+        uint32_t count;
+        int64_t isum, isum2;   // integer types
+        double mean, m2;       // floating point types
+};
+
+
+template<typename T, uint32_t _size>
+void Running_Stats<T,_size>::add(T value, std::false_type) {
+  count++;
+  const double delta = value - mean;
+  mean += delta / count;
+  m2 += delta * (value - mean);
+}
+
+template<typename T, uint32_t _size>
+void Running_Stats<T,_size>::remove(T value, std::false_type) {
+  if ( count <= 1 ) {
+    reset();
+    return;
+  }
+  count--;
+  const double delta = value - mean;
+  mean -= delta / count;
+  m2 -= delta * (value - mean);
+  if ( m2 < 0 ) m2 = 0; // rounding
+}
+
+template<typename T, uint32_t _size>
+T Running_Stats<T,_size>::window_variance(std::true_type) const {
+  // sum((x - m)^2) = sum(x^2) - 2*m*sum(x) + n*m^2, with m the truncated mean
+  const int64_t n = count;
+  const int64_t m = isum / n;
+  return (T)((isum2 - 2*m*isum + n*m*m) / n);
+}
+
+// Sliding window median in O(log n) per value, without reordering the buffer.
+// The window is split between a max-heap holding its lower half and a min-heap holding its upper half,
+// with the lower half holding one more value when the window size is odd. Heap entries are the ring
+// slots of the values, and each slot remembers its heap and position, so that the value leaving the
+// window can be removed from the middle of its heap. The median is the top of the lower half, or the
+// mean of both tops for an even window size (in T arithmetic, as Circular_Buffer::median()).
+
+template<typename T, uint32_t _size>
+class Sliding_Median {
+    public:
+        T window_median() const;
+
+    protected:
+        Sliding_Median() { reset(); }
+        void init(uint32_t capacity) { lo.init(capacity); hi.init(capacity); pos.init(capacity); in_hi.init(capacity); val.init(capacity); }
+        void on_push_back(T value);
+        void on_pop_front(T value);
+        void reset() { pushed = popped = 0; n_lo = n_hi = 0; }
+
+    private:
+        // true if slot a belongs above slot b in the lower (max-) or upper (min-) heap
+        bool above(bool upper, uint32_t a, uint32_t b) const { return upper ? val[a] < val[b] : val[b] < val[a]; }
+        Policy_Ring<uint32_t,_size>& heap(bool upper) { return upper ? hi : lo; }
+        void heap_set(bool upper, uint32_t i, uint32_t slot);
+        void heap_push(bool upper, uint32_t slot);
+        uint32_t heap_pop(bool upper) { const uint32_t slot = heap(upper)[0]; heap_erase(upper, 0); return slot; }
+        void heap_erase(bool upper, uint32_t i);
+        void sift_up(bool upper, uint32_t i);
+        void sift_down(bool upper, uint32_t i);
+        void rebalance();
+
+        uint32_t pushed, popped;    // sequence numbers of the next value pushed and of the next value popped
+        uint32_t n_lo, n_hi;        // heap sizes
+        Policy_Ring<uint32_t,_size> lo, hi;   // heaps of slots (slots are sequence numbers modulo the ring size)
+        Policy_Ring<uint32_t,_size> pos;      // position of each slot in its heap
+        Policy_Ring<uint8_t,_size>  in_hi;    // heap of each slot
+        Policy_Ring<T,_size>        val;      // value of each slot
+};
+
+
+template<typename T, uint32_t _size>
+T Sliding_Median<T,_size>::window_median() const {
+  if ( n_lo > n_hi ) return val[lo[0]];
+  return ( val[lo[0]] + val[hi[0]] ) / 2;
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::on_push_back(T value) {
+  const uint32_t slot = pushed++;
+  val[slot] = value;
+  heap_push( n_lo && val[lo[0]] < value, slot );
+  rebalance();
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::on_pop_front(T value) {
+  (void)value;
+  const uint32_t slot = popped++;
+  heap_erase(in_hi[slot] != 0, pos[slot]);
+  rebalance();
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::rebalance() {
+  if ( n_lo > n_hi + 1 ) heap_push(true, heap_pop(false));
+  else if ( n_hi > n_lo ) heap_push(false, heap_pop(true));
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::heap_set(bool upper, uint32_t i, uint32_t slot) {
+  heap(upper)[i] = slot;
+  pos[slot] = i;
+  in_hi[slot] = upper;
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::heap_push(bool upper, uint32_t slot) {
+  const uint32_t i = upper ? n_hi++ : n_lo++;
+  heap_set(upper, i, slot);
+  sift_up(upper, i);
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::heap_erase(bool upper, uint32_t i) {
+  Policy_Ring<uint32_t,_size> &h = heap(upper);
+  const uint32_t last = upper ? --n_hi : --n_lo;
+  if ( i == last ) return;
+  const uint32_t moved = h[last];
+  heap_set(upper, i, moved);
+  sift_up(upper, i);
+  if ( pos[moved] == i ) sift_down(upper, i);
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::sift_up(bool upper, uint32_t i) {
+  Policy_Ring<uint32_t,_size> &h = heap(upper);
+  const uint32_t slot = h[i];
+  while ( i > 0 ) {
+    const uint32_t parent = (i - 1) / 2;
+    if ( !above(upper, slot, h[parent]) ) break;
+    heap_set(upper, i, h[parent]);
+    i = parent;
+  }
+  heap_set(upper, i, slot);
+}
+
+template<typename T, uint32_t _size>
+void Sliding_Median<T,_size>::sift_down(bool upper, uint32_t i) {
+  Policy_Ring<uint32_t,_size> &h = heap(upper);
+  const uint32_t n = upper ? n_hi : n_lo;
+  const uint32_t slot = h[i];
+  while ( 2*i + 1 < n ) {
+    uint32_t child = 2*i + 1;
+    if ( child + 1 < n && above(upper, h[child+1], h[child]) ) child++;
+    if ( !above(upper, h[child], slot) ) break;
+    heap_set(upper, i, h[child]);
+    i = child;
+  }
+  heap_set(upper, i, slot);
+}
+
+#endif // CIRCULAR_BUFFER_POLICIES_H
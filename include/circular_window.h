@@ -0,0 +1,202 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Sliding window of samples with arbitrary capacity and 32-bit indices.
+// Unlike Circular_Buffer, the capacity need not be a power of 2 and may exceed 65535 samples:
+//  - Circular_Window<T, N, Policies...> has a capacity of N samples fixed at compile time;
+//    indices wrap with a mask when N is a power of 2, and with a compare-and-subtract otherwise;
+//  - Circular_Window<T, 0, Policies...> takes its capacity at construction, for windows derived
+//    from the sampling rate.
+// Pushing into a full window drops the oldest sample. The statistics use the same policies as
+// Circular_Buffer (see circular_buffer_policies.h), and fall back to scanning the window otherwise.
+
+#ifndef CIRCULAR_WINDOW_H
+#define CIRCULAR_WINDOW_H
+
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+#include "circular_buffer_policies.h"
+
+// Sample storage of a window with capacity fixed at compile time.
+template<typename T, uint32_t _size>
+class Circular_Window_Storage {
+    public:
+        void init(uint32_t capacity) { (void)capacity; }
+        uint32_t capacity() const { return _size; }
+        uint32_t wrap(uint32_t i) const { return (_size & (_size-1)) == 0 ? i & (_size-1) : ( i >= _size ? i - _size : i ); }
+        T* data() { return _cbuf; }
+        const T* data() const { return _cbuf; }
+
+    private:
+        T _cbuf[_size];
+};
+
+// Sample storage of a window with capacity chosen at run time.
+template<typename T>
+class Circular_Window_Storage<T, 0> {
+    public:
+        void init(uint32_t capacity) { _cbuf.assign(std::max(capacity, 1u), T()); }
+        uint32_t capacity() const { return (uint32_t) _cbuf.size(); }
+        uint32_t wrap(uint32_t i) const { return i >= capacity() ? i - capacity() : i; }
+        T* data() { return _cbuf.data(); }
+        const T* data() const { return _cbuf.data(); }
+
+    private:
+        std::vector<T> _cbuf;
+};
+
+template<typename T, uint32_t _size = 0, template<typename, uint32_t> class... Policies>
+class Circular_Window : public Policies<T,_size>... {
+    public:
+        explicit Circular_Window(uint32_t capacity = _size);
+
+        void push_back(T value);
+        T pop_front();
+        // value pos places after the oldest one, 0 when pos is not below size()
+        T peek(uint32_t pos = 0) const { return pos < _available ? store.data()[store.wrap(head+pos)] : 0; }
+        T front() const { return peek(0); }
+        T back() const { return peek(_available-1); }
+        void clear() { head = _available = 0; policies_reset(); }
+        uint32_t size() const { return _available; }
+        uint32_t available() const { return _available; }
+        uint32_t capacity() const { return store.capacity(); }
+        bool empty() const { return _available == 0; }
+        bool full() const { return _available == store.capacity(); }
+        // statistics of the window, 0 when the window is empty
+        T sum() { return _available ? sum(has_policy<Running_Stats>()) : 0; }
+        T average() { return _available ? average(has_policy<Running_Stats>()) : 0; }
+        T mean() { return average(); }
+        T variance() { return _available ? variance(has_policy<Running_Stats>()) : 0; }
+        T deviation();
+        T min() { return _available ? min(has_policy<Windowed_Extremum>()) : 0; }
+        T max() { return _available ? max(has_policy<Windowed_Extremum>()) : 0; }
+        T median() { return _available ? median(has_policy<Sliding_Median>()) : 0; }
+
+    private:
+        // policy notifications (see circular_buffer_policies.h)
+        void policies_init(uint32_t capacity) { int expand[] = { 0, (Policies<T,_size>::init(capacity), 0)... }; (void)expand; (void)capacity; }
+        void policies_push(T value) { int expand[] = { 0, (Policies<T,_size>::on_push_back(value), 0)... }; (void)expand; (void)value; }
+        void policies_pop(T value) { int expand[] = { 0, (Policies<T,_size>::on_pop_front(value), 0)... }; (void)expand; (void)value; }
+        void policies_reset() { int expand[] = { 0, (Policies<T,_size>::reset(), 0)... }; (void)expand; }
+        template<template<typename, uint32_t> class Policy> struct has_policy : std::is_base_of<Policy<T,_size>, Circular_Window> { };
+
+        // the window is data()[head...end1-1] followed by data()[0...end2-1]
+        uint32_t end1() const { return std::min(head + _available, store.capacity()); }
+        uint32_t end2() const { return head + _available - end1(); }
+
+        T max(std::true_type) { return Windowed_Extremum<T,_size>::window_max(); }
+        T max(std::false_type);
+        T min(std::true_type) { return Windowed_Extremum<T,_size>::window_min(); }
+        T min(std::false_type);
+        T sum(std::true_type) { return Running_Stats<T,_size>::window_sum(); }
+        T sum(std::false_type);
+        T average(std::true_type) { return Running_Stats<T,_size>::window_mean(); }
+        T average(std::false_type) { return sum()/_available; }
+        T variance(std::true_type) { return Running_Stats<T,_size>::window_variance(); }
+        T variance(std::false_type);
+        T median(std::true_type) { return Sliding_Median<T,_size>::window_median(); }
+        T median(std::false_type);
+
+        Circular_Window_Storage<T,_size> store;
+        uint32_t head = 0;
+        uint32_t _available = 0;
+        std::vector<T> scratch;    // median() work area
+};
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+Circular_Window<T,_size,Policies...>::Circular_Window(uint32_t capacity) {
+  store.init(capacity);
+  policies_init(store.capacity());
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+void Circular_Window<T,_size,Policies...>::push_back(T value) {
+  if ( full() ) pop_front(); // oldest value is dropped
+  store.data()[store.wrap(head+_available)] = value;
+  _available++;
+  policies_push(value);
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+T Circular_Window<T,_size,Policies...>::pop_front() {
+  if ( !_available ) return 0;
+  const T value = store.data()[head];
+  head = store.wrap(head+1);
+  _available--;
+  policies_pop(value);
+  return value;
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+T Circular_Window<T,_size,Policies...>::deviation() {
+  if ( !_available ) return 0;
+  return sqrt(variance());
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+T Circular_Window<T,_size,Policies...>::sum(std::false_type) {
+  const T *data = store.data();
+  T value = 0;
+  for ( uint32_t i = head; i < end1(); i++ ) value += data[i];
+  for ( uint32_t i = 0; i < end2(); i++ ) value += data[i];
+  return value;
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+T Circular_Window<T,_size,Policies...>::variance(std::false_type) {
+  const T *data = store.data();
+  const T _mean = average();
+  T value = 0;
+  for ( uint32_t i = head; i < end1(); i++ ) value += (data[i] - _mean) * (data[i] - _mean);
+  for ( uint32_t i = 0; i < end2(); i++ ) value += (data[i] - _mean) * (data[i] - _mean);
+  return value / _available;
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+T Circular_Window<T,_size,Policies...>::max(std::false_type) {
+  const T *data = store.data();
+  T value = *std::max_element(data + head, data + end1());
+  if ( end2() ) value = std::max(value, *std::max_element(data, data + end2()));
+  return value;
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+T Circular_Window<T,_size,Policies...>::min(std::false_type) {
+  const T *data = store.data();
+  T value = *std::min_element(data + head, data + end1());
+  if ( end2() ) value = std::min(value, *std::min_element(data, data + end2()));
+  return value;
+}
+
+template<typename T, uint32_t _size, template<typename, uint32_t> class... Policies>
+T Circular_Window<T,_size,Policies...>::median(std::false_type) {
+  const T *data = store.data();
+  scratch.assign(data + head, data + end1());
+  scratch.insert(scratch.end(), data, data + end2());
+  const typename std::vector<T>::iterator mid = scratch.begin() + _available/2;
+  std::nth_element(scratch.begin(), mid, scratch.end());
+  if ( _available % 2 ) return *mid;
+  return ( *std::max_element(scratch.begin(), mid) + *mid ) / 2; // lower middle is the largest value below mid
+}
+
+#endif // CIRCULAR_WINDOW_H
@@ -0,0 +1,92 @@
+/**
+ * \file
+ * \copyright  Copyright 2014-2016 PLUX - Wireless Biosignals, S.A.
+ * 
+ * \section LICENSE
+ 
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU Lesser General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ 
+ */
+
+// CRC4 of BITalino frames: the last byte of a frame holds its sequence number (high nibble) and the
+// CRC4 of the frame (low nibble). Shared by bitalino.cpp and the benchmarks.
+
+#ifndef _CRC4HEADER_
+#define _CRC4HEADER_
+
+// CRC4 check function
+
+static const unsigned char CRC4tab[16] = {0, 3, 6, 5, 12, 15, 10, 9, 11, 8, 13, 14, 7, 4, 1, 2};
+
+inline bool checkCRC4(const unsigned char *data, int len)
+{
+   unsigned char crc = 0;
+
+   for (int i = 0; i < len-1; i++)
+   {
+      const unsigned char b = data[i];
+      crc = CRC4tab[crc] ^ (b >> 4);
+      crc = CRC4tab[crc] ^ (b & 0x0F);
+   }
+
+   // CRC for last byte
+   crc = CRC4tab[crc] ^ (data[len-1] >> 4);
+   crc = CRC4tab[crc];
+
+   return (crc == (data[len-1] & 0x0F));
+}
+
+// Byte-wise CRC4 tables for batches of frames.
+// The CRC is linear, so processing byte b updates crc to CRC4tab2[crc] ^ CRC4bytetab[b],
+// where CRC4tab2[c] = CRC4tab[CRC4tab[c]] and CRC4bytetab[b] = CRC4tab[b >> 4] ^ (b & 0x0F).
+// Running this over a whole frame, including its CRC nibble, yields 0 for a valid frame.
+
+static const unsigned char CRC4tab2[16] = {0, 5, 10, 15, 7, 2, 13, 8, 14, 11, 4, 1, 9, 12, 3, 6};
+
+static const unsigned char CRC4bytetab[256] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    3,  2,  1,  0,  7,  6,  5,  4, 11, 10,  9,  8, 15, 14, 13, 12,
+    6,  7,  4,  5,  2,  3,  0,  1, 14, 15, 12, 13, 10, 11,  8,  9,
+    5,  4,  7,  6,  1,  0,  3,  2, 13, 12, 15, 14,  9,  8, 11, 10,
+   12, 13, 14, 15,  8,  9, 10, 11,  4,  5,  6,  7,  0,  1,  2,  3,
+   15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0,
+   10, 11,  8,  9, 14, 15, 12, 13,  2,  3,  0,  1,  6,  7,  4,  5,
+    9,  8, 11, 10, 13, 12, 15, 14,  1,  0,  3,  2,  5,  4,  7,  6,
+   11, 10,  9,  8, 15, 14, 13, 12,  3,  2,  1,  0,  7,  6,  5,  4,
+    8,  9, 10, 11, 12, 13, 14, 15,  0,  1,  2,  3,  4,  5,  6,  7,
+   13, 12, 15, 14,  9,  8, 11, 10,  5,  4,  7,  6,  1,  0,  3,  2,
+   14, 15, 12, 13, 10, 11,  8,  9,  6,  7,  4,  5,  2,  3,  0,  1,
+    7,  6,  5,  4,  3,  2,  1,  0, 15, 14, 13, 12, 11, 10,  9,  8,
+    4,  5,  6,  7,  0,  1,  2,  3, 12, 13, 14, 15,  8,  9, 10, 11,
+    1,  0,  3,  2,  5,  4,  7,  6,  9,  8, 11, 10, 13, 12, 15, 14,
+    2,  3,  0,  1,  6,  7,  4,  5, 10, 11,  8,  9, 14, 15, 12, 13};
+
+// Checks nFrames consecutive frames of len bytes each.
+// Returns the number of leading frames which passed the CRC check (same result as checkCRC4() on each frame).
+template<int len>
+inline int checkCRC4Frames(const unsigned char *data, int nFrames)
+{
+   for (int n = 0; n < nFrames; n++, data += len)
+   {
+      unsigned char crc = 0;
+      for (int i = 0; i < len; i++)
+         crc = CRC4tab2[crc] ^ CRC4bytetab[data[i]];
+
+      if (crc != 0)  return n;
+   }
+
+   return nFrames;
+}
+
+#endif // _CRC4HEADER_
@@ -0,0 +1,142 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _TRANSPORTHEADER_
+#define _TRANSPORTHEADER_
+
+#ifndef _WIN32 // Linux or Mac OS
+
+#include <stdio.h>
+#include <string>
+#include <time.h>
+
+/// Byte stream connection to a %BITalino device (Linux and Mac OS).
+/// Transports are non-blocking: read() never waits, and the descriptor returned by fd() can be
+/// registered with select(), poll() or an external epoll loop to wait until read() may return data.
+/// Errors are reported by throwing BITalino::Exception.
+class Transport
+{
+public:
+   /** Opens a transport from a device address.
+    * \param[in] address One of:
+    * - a Bluetooth MAC address ("xx:xx:xx:xx:xx:xx") for a direct RFCOMM connection (requires HASBLUETOOTH);
+    * - a serial port ("/dev/...");
+    * - "replay:" followed by the path of a recorded device byte stream (Linux only).
+    * \return A new transport, owned by the caller
+    * \exception BITalino::Exception (Exception::PORT_COULD_NOT_BE_OPENED)
+    * \exception BITalino::Exception (Exception::PORT_INITIALIZATION)
+    * \exception BITalino::Exception (Exception::INVALID_ADDRESS)
+    */
+   static Transport* open(const char *address);
+
+   virtual ~Transport() {}
+
+   /// Returns the descriptor which becomes readable when read() may return data.
+   virtual int fd(void) const = 0;
+
+   /** Reads the bytes available from the device without waiting.
+    * \return Number of bytes read (0 if no data is available yet)
+    * \exception BITalino::Exception (Exception::CONTACTING_DEVICE)
+    */
+   virtual int read(void *data, int maxbyttoread) = 0;
+
+   /** Writes bytes to the device, waiting up to 5 seconds if it cannot accept them.
+    * \exception BITalino::Exception (Exception::CONTACTING_DEVICE)
+    */
+   virtual void write(const void *data, int nbyttowrite) = 0;
+};
+
+/// Transport on a single non-blocking file descriptor.
+class FdTransport : public Transport
+{
+public:
+   ~FdTransport();
+
+   int  fd(void) const { return handle; }
+   int  read(void *data, int maxbyttoread);
+   void write(const void *data, int nbyttowrite);
+
+protected:
+   FdTransport() : handle(-1) {}
+
+   int handle;
+};
+
+/// Serial port transport (termios), for wired UART connections or indirect Bluetooth connections.
+class SerialTransport : public FdTransport
+{
+public:
+   SerialTransport(const char *path);
+};
+
+#ifdef HASBLUETOOTH
+/// Direct Bluetooth RFCOMM socket transport (Linux only).
+class RfcommTransport : public FdTransport
+{
+public:
+   RfcommTransport(const char *macAddress);
+};
+#endif // HASBLUETOOTH
+
+/// Pseudo-terminal loopback transport.
+/// The bridge uses the master side, while a device simulator or a test harness opens
+/// the slave side (a serial port named by slaveName()) and plays the device.
+class PtyTransport : public FdTransport
+{
+public:
+   PtyTransport();
+
+   /// Returns the path of the slave side ("/dev/pts/...").
+   const char* slaveName(void) const { return slave.c_str(); }
+
+private:
+   std::string slave;
+};
+
+#ifdef __linux__
+/// Replay of a recorded device byte stream (Linux only).
+/// The transport answers the version command, and after a start command it streams the recorded bytes
+/// (looping at end of file) paced at the requested sampling rate. fd() is a timer descriptor.
+class ReplayTransport : public Transport
+{
+public:
+   ReplayTransport(const char *path);
+   ~ReplayTransport();
+
+   int  fd(void) const { return timer; }
+   int  read(void *data, int maxbyttoread);
+   void write(const void *data, int nbyttowrite);
+
+private:
+   void command(unsigned char cmd);
+   void arm(void);
+
+   FILE        *file;
+   int         timer;
+   std::string reply;         ///< Pending reply to a command
+   bool        streaming, pwmValue;
+   int         samplingRate, frameSize;
+   timespec    started;       ///< Time of the start command
+   long long   framesSent;
+};
+#endif // __linux__
+
+#endif // Linux or Mac OS
+
+#endif // _TRANSPORTHEADER_
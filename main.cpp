@@ -18,14 +18,21 @@
 */
 
 #include "bitalino.h"
+#include "acquisition.h"
 #include "lsl_cpp.h"
 
-#include "ButterworthFilter.h"
-#include "SimpleFilter.h"
-#include "circular_buffer.h"
+#include "BiquadBank.h"
+#include "HRVAnalyzer.h"
+#include "QRSDetector.h"
+#include "RespirationAnalyzer.h"
+#include "circular_window.h"
 
+#include <chrono>
 #include <iostream>
+#include <signal.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 
 using namespace std;
 
@@ -38,87 +45,44 @@ double beat_time = 250000;
 // sampling rate of the ECG sensor (in Hz)
 static int samplingRate = 100;
 
-// buffer for processing
-// WARNING: with current library, buffer size limited to powers of 2
-Circular_Buffer<long, 8> ecg_smoothing;
-// trend buffer will be filled every now and then
-const unsigned int ecg_decimation = 8;
-Circular_Buffer<long, 32> ecg_trend; // approx. 0.250s * decimation
+// filters for processing ECG: 1-20 Hz Butterworth band-pass (2 biquads)
+BiquadCascade<double> filter_ecg_bandpass(BiquadCascade<double>::BandPass, samplingRate, 1, 20, 2);
 
-// filters for processing ECG
-HighPassFilter<long> filter_ecg_highpass(samplingRate, 1);
-ButterworthFilter<long> filter_ecg_lowpass(samplingRate, 20);
+// band-pass filters of the six analog channels, one SIMD lane per channel:
+// ECG design on A1, respiration design on A2, EEG alpha design on A3 (set in main), 0.5-40 Hz on the others
+BiquadBank channel_filters(6, BiquadCascade<double>(BiquadCascade<double>::BandPass, samplingRate, 0.5, 40, 2));
 
-// counter to prevent double beats
+// sample counter
 uint32_t tick = 0;
-uint32_t tick_ecg_start = 0;
-double isECGing = false;
-// double ecg_time = 400000; // 0.4s, no more than 150BPM
-double ecg_time = 40; // 0.4s, no more than 150BPM
 
 // compute BPM with each new beat
 float hr_insta = 60;
 
-// filtering ECG return true if a beat is detected
-// ecg_raw: raw value from ECG
-bool updateECG(long ecg_raw) {
-  // intermediate values for variable of interest, keep previous to compute first derivative
-  static long ecg_bandpass = 0;
-  static long ecg_bandpass_prev = 0;
-  // tracking when we should update trend buffer
-  static int ecg_decimation_n = 0;
-
-  bool beating = false;
-  // band-pass filter to clean signal
-  ecg_bandpass_prev = ecg_bandpass;
-  filter_ecg_highpass.step(ecg_raw);
-  filter_ecg_lowpass.step(filter_ecg_highpass.getValue());
-  ecg_bandpass = filter_ecg_lowpass.getValue();
-  // derivative to increase difference
-  long ecg_derivative = ecg_bandpass - ecg_bandpass_prev;
-  // power, even more
-  long ecg_power = ecg_derivative * ecg_derivative;
-  // smoothing time window
-  ecg_smoothing.push_back(ecg_power);
-  long ecg_smoothed = ecg_smoothing.mean(); // staying integer, loos resolution but gain speed
-  // add values to compute trend
-  ecg_decimation_n++;
-  if (ecg_decimation_n >= ecg_decimation) {
-    ecg_decimation_n = 0;
-    ecg_trend.push_back(ecg_smoothed);
-  }
-
-  // detect beat by comparing short window to long window
-  long ecg_trig = 0;
-  if (ecg_smoothed > ecg_trend.max() / 2 && ecg_smoothed > ecg_trend.mean() * 2) {
-    ecg_trig = ecg_trend.max();
-    beating = true;
-  }
-
-  return beating;
-}
-
 // =============================================================================
 
 class filter
 {
 public:
-    filter(int samplingRate, int hf, int lf)
+    filter(int samplingRate, int hf, int lf) :
+        smoothing(samplingRate * 8 / 100), trend(samplingRate * 32 / 100),
+        filter_bandpass(BiquadCascade<double>::BandPass, samplingRate, hf, lf, 2)
+    {
+    }
+    
+    // band-pass design of the input of update()
+    const BiquadCascade<double>& bandpass_design() const
     {
-        filter_highpass = new HighPassFilter<long>(samplingRate, hf);
-        filter_lowpass = new ButterworthFilter<long>(samplingRate, lf);
+        return filter_bandpass;
     }
     
-    long update(long rawdata)
+    long update(double filtered)
     {
         bandpass_prev = bandpass;
-        filter_highpass->step(rawdata);
-        filter_lowpass->step(filter_highpass->getValue());
-        bandpass = filter_lowpass->getValue();
+        bandpass = filtered;
         
-        long derivative = bandpass - bandpass_prev;
+        double derivative = bandpass - bandpass_prev;
         
-        long power = derivative * derivative;
+        long power = lround(derivative * derivative);
         
         smoothing.push_back(power);
         long smoothed = smoothing.mean();
@@ -134,36 +98,22 @@ public:
     }
     
 private:
-    long bandpass = 0;
-    long bandpass_prev = 0;
+    double bandpass = 0;
+    double bandpass_prev = 0;
     
     int decimation_n = 0;
     
-    Circular_Buffer<long, 8> smoothing;
+    Circular_Window<long, 0, Running_Stats> smoothing;
     
     const unsigned int decimation = 8;
-    Circular_Buffer<long, 32> trend;
+    Circular_Window<long, 0, Windowed_Extremum> trend;
     
-    HighPassFilter<long> *filter_highpass;
-    ButterworthFilter<long> *filter_lowpass;
+    BiquadCascade<double> filter_bandpass;
     
 };
 
 // =============================================================================
 
-bool keypressed(void)
-{
-    fd_set readfds;
-    FD_ZERO(&readfds);
-    FD_SET(0, &readfds);
-    
-    timeval readtimeout;
-    readtimeout.tv_sec = 0;
-    readtimeout.tv_usec = 0;
-    
-    return (select (FD_SETSIZE, &readfds, NULL, NULL, &readtimeout) == 1);
-}
-
 void description(void)
 {
     cout << "Usage: lsl_bridge [BITalino's MacAddress] [LSL name] [Sensors]" << endl;
@@ -213,6 +163,27 @@ int main(int argc, char* argv[])
         return 0;
     }
     
+    filter alpha(100, 8, 12);
+    QRSDetector qrs(samplingRate);
+    HRVAnalyzer hrv(60, 120, 5);
+    RespirationAnalyzer respiration(samplingRate);
+    
+    // band-pass designs of A1 (ECG), A2 (RESP) and A3 (EEG), checked before connecting to the device
+    const BiquadCascade<double> *designs[3] = { &filter_ecg_bandpass, &respiration.getDesign(), &alpha.bandpass_design() };
+    const char *design_names[3] = { "ECG", "respiration", "EEG" };
+    for (int k = 0; k < 3; k++)
+    {
+        if (!channel_filters.setChannel(k, *designs[k]))
+        {
+            cerr << "The " << design_names[k] << " band-pass filter does not fit the filter bank of channel A" << k + 1 << "." << endl;
+            return 1;
+        }
+    }
+    
+    // delay of the ECG band-pass (s) at the centre of the QRS energy (10 Hz, the middle of its 5-15 Hz band),
+    // by which the R peaks of the band-passed ECG come after those of the raw ECG
+    const double ecg_delay = filter_ecg_bandpass.getGroupDelay(samplingRate, 10) / samplingRate;
+    
     try
     {
         // initialize bitalino
@@ -221,12 +192,18 @@ int main(int argc, char* argv[])
         cout << ver.c_str() << endl;
         
         // make a new stream_info & outlet
-        lsl::stream_info *info_hr, *info_resp, *info_eeg,*info_alpha, *info_ecg;
-        lsl::stream_outlet *outlet_hr, *outlet_resp, *outlet_eeg, *outlet_alpha, *outlet_ecg;
+        lsl::stream_info *info_hr, *info_rr, *info_hrv, *info_resp, *info_eeg,*info_alpha, *info_ecg;
+        lsl::stream_outlet *outlet_hr, *outlet_rr, *outlet_hrv, *outlet_resp, *outlet_eeg, *outlet_alpha, *outlet_ecg;
         if (hr_enable)
         {
             info_hr = new lsl::stream_info(lslname.c_str(), "heartrate", 1, 0, lsl::cf_float32, "bitalinoHR_" + macAddress);
             outlet_hr = new lsl::stream_outlet(*info_hr);
+            // one sample per beat: RR interval (s) and heart rate (BPM), stamped with the time of the R peak
+            info_rr = new lsl::stream_info(lslname.c_str(), "rr", 2, 0, lsl::cf_float32, "bitalinoRR_" + macAddress);
+            outlet_rr = new lsl::stream_outlet(*info_rr);
+            // one sample per beat: RMSSD (ms), SDNN (ms), pNN50 (%) over 60 beats, LF (ms^2), HF (ms^2), LF/HF over 2 min
+            info_hrv = new lsl::stream_info(lslname.c_str(), "hrv", 6, 0, lsl::cf_float32, "bitalinoHRV_" + macAddress);
+            outlet_hrv = new lsl::stream_outlet(*info_hrv);
         }
 
         if (resp_enable)
@@ -247,117 +224,212 @@ int main(int argc, char* argv[])
             outlet_ecg = new lsl::stream_outlet(*info_ecg);
         }
         
-        // 100Hz A1(ECG) A2(RESP) A3(EEG)
-        dev.start(100, { 0, 1, 2 });
+        // 100Hz A1(ECG) A2(RESP) A3(EEG) A4-A6
+        dev.start(100, { 0, 1, 2, 3, 4, 5 });
         
-        BITalino::VFrame frames(1);
+        BITalino::FrameBatch frames;
+        frames.resize(100);
+        vector<float> filtered[6];
+        const short *channels[6];
+        float *filtered_channels[6];
+        for (int k = 0; k < 6; k++)
+        {
+            filtered[k].resize(frames.size());
+            channels[k] = &frames.analog[k][0];
+            filtered_channels[k] = &filtered[k][0];
+        }
         float lslSample_hr[1];
+        float lslSample_rr[2];
+        float lslSample_hrv[6];
         float lslSample_resp[3];
         float lslSample_ecg[1];
         float lslSample_eeg[1];
         float lslSample_alpha[1];
         
+        // block termination signals before starting the acquisition thread, so that only the signalfd receives them
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        sigprocmask(SIG_BLOCK, &signals, NULL);
+        const int sigfd = signalfd(-1, &signals, 0);
+        
+        // a dedicated thread reads the device (and detects a lost connection), this thread processes the frames
+        Acquisition acq(dev);
+        
+        // wait on new frames, stdin and termination signals together
+        const int epfd = epoll_create1(0);
+        const int sources[3] = { acq.fd(), STDIN_FILENO, sigfd };
+        for (int k = 0; k < 3; k++)
+        {
+            epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.fd = sources[k];
+            epoll_ctl(epfd, EPOLL_CTL_ADD, sources[k], &ev);
+        }
+        
         cout << "Press Enter to exit." << endl;
         
-        filter alpha(100, 8, 12);
-            
-        do
+        bool running = true;
+        while (running)
         {
-            // count timing
-            tick++;
+            epoll_event events[3];
+            const int nEvents = epoll_wait(epfd, events, 3, -1);
             
-            // get analog data and create 100Hz timing
-            dev.read(frames);
-            
-            const BITalino::Frame& f = frames[0];
-            int data_ecg = f.analog[0];     // ECG
-            int data_resp = f.analog[1];    // RESP
-            int data_eeg = f.analog[2];     // EEG
+            for (int e = 0; e < nEvents; e++)
+            {
+                const int source = events[e].data.fd;
+                
+                if (source == STDIN_FILENO || source == sigfd)
+                {
+                    // Press Enter (or Ctrl+C) to exit.
+                    running = false;
+                    if (source == STDIN_FILENO)
+                    {
+                        string line;
+                        getline(cin, line);
+                    }
+                }
+            }
             
-            // filter ECG, retrieve beat detection
-            bool beat = updateECG(data_ecg);
+            if (!running)   break;
             
-            // new beat
-            if (beat and !isECGing)
+            // get all analog data received so far
+            int nFrames;
+            do
             {
-                // start of new QRS complex
-                isECGing = true;
+                std::chrono::steady_clock::time_point received;
+                nFrames = acq.read(frames, &received);
+                // LSL time at which the acquisition thread received the last frame of the batch
+                const double batch_time = nFrames ? lsl::local_clock() - std::chrono::duration<double>(std::chrono::steady_clock::now() - received).count() : 0;
                 
-                // computing intantaneous heart-rate
-                // WARNING: the very first HR value will be off, you should implement a mecanism to detect when a new user touch the sensor, and only take into account HR value starting from the second QRS complex.
-                hr_insta = 6000 / (tick - tick_ecg_start);
+                // band-pass the whole batch, all channels at once
+                channel_filters.step(channels, filtered_channels, nFrames);
                 
-                tick_ecg_start = tick;
+                for (int i = 0; i < nFrames; i++)
+                {
+                    // count timing
+                    tick++;
+            
+                    int data_ecg = frames.analog[0][i];     // ECG
+                    int data_resp = frames.analog[1][i];    // RESP
+                    int data_eeg = frames.analog[2][i];     // EEG
+            
+                    // new beat, detected on the band-passed ECG
+                    if (qrs.update(filtered[0][i]))
+                    {
+                        // computing intantaneous heart-rate from the interval between R peaks, from the second QRS complex
+                        const double rr = qrs.getPeakInterval() / samplingRate;
+                        if (rr > 0)
+                            hr_insta = 60 / rr;
+                        
+                        // LSL time of the R peak (samples behind the end of the batch, less the band-pass delay)
+                        const double behind = (nFrames - 1 - i) + (qrs.getSampleIndex() - 1 - qrs.getPeakPosition());
+                        const double peak_time = batch_time - behind / samplingRate - ecg_delay;
+                        const bool hrv_beat = rr > 0 && hrv.update(rr, peak_time);
                 
-                // INSERT HERE CODE YOU WOULD LIKE TO TRIGGER WITH EACH NEW BEAT
+                        // INSERT HERE CODE YOU WOULD LIKE TO TRIGGER WITH EACH NEW BEAT
                 
-                printf("Beat!\n");
+                        printf("Beat!\n");
                 
-                // send LSL HRdata
-                if (hr_enable)
-                {
-                    lslSample_hr[0] = hr_insta;
-                    outlet_hr->push_sample(lslSample_hr);
-                }
-            }
+                        // send LSL HRdata
+                        if (hr_enable)
+                        {
+                            lslSample_hr[0] = hr_insta;
+                            outlet_hr->push_sample(lslSample_hr);
+                            
+                            // RR interval, at the time of the R peak
+                            if (rr > 0)
+                            {
+                                lslSample_rr[0] = rr;
+                                lslSample_rr[1] = hr_insta;
+                                outlet_rr->push_sample(lslSample_rr, peak_time);
+                            }
+                            
+                            // HRV, with each accepted interval
+                            if (hrv_beat)
+                            {
+                                lslSample_hrv[0] = hrv.getRMSSD();
+                                lslSample_hrv[1] = hrv.getSDNN();
+                                lslSample_hrv[2] = hrv.getPNN50();
+                                lslSample_hrv[3] = hrv.getLF();
+                                lslSample_hrv[4] = hrv.getHF();
+                                lslSample_hrv[5] = hrv.getLFHF();
+                                outlet_hrv->push_sample(lslSample_hrv, peak_time);
+                            }
+                        }
+                    }
             
-            // refractory time before new beat
-            if (isECGing and tick - tick_ecg_start > ecg_time) 
-            {
-                isECGing = false;
-            }
+                    // track breaths on the band-passed respiration
+                    respiration.update(filtered[1][i]);
             
-            // send LSL Resp 10Hz
-            if (resp_enable)
-            {
-                if (tick % 10 == 0)
-                {
-                    lslSample_resp[0] = data_resp;
-                    lslSample_resp[1] = (float)data_resp / 1023.0f;
-                    lslSample_resp[2] = 0;
-                    outlet_resp->push_sample(lslSample_resp);
-                }
-            }
+                    // send LSL Resp 10Hz: raw value, amplitude of the last breath (full scale 1), breaths per minute
+                    if (resp_enable)
+                    {
+                        if (tick % 10 == 0)
+                        {
+                            lslSample_resp[0] = data_resp;
+                            lslSample_resp[1] = (float)respiration.getAmplitude() / 1023.0f;
+                            lslSample_resp[2] = (float)respiration.getRate();
+                            outlet_resp->push_sample(lslSample_resp);
+                        }
+                    }
             
-            //long eeg_alpha = updateEEG(data_eeg);
+                    //long eeg_alpha = updateEEG(data_eeg);
             
-            // send LSL EEG
-            if (eeg_enable)
-            {
-                // RAW
-                lslSample_eeg[0] = data_eeg;
-                //outlet_eeg->push_sample(lslSample_eeg);
+                    // send LSL EEG
+                    if (eeg_enable)
+                    {
+                        // RAW
+                        lslSample_eeg[0] = data_eeg;
+                        //outlet_eeg->push_sample(lslSample_eeg);
                 
-                // Alpha
-                long eeg_alpha = alpha.update(data_eeg) / 10;
-                if(eeg_alpha > 100) { eeg_alpha = 100; }
-                lslSample_alpha[0] = (float)eeg_alpha * 0.01f;
-                outlet_alpha->push_sample(lslSample_alpha);
+                        // Alpha
+                        long eeg_alpha = alpha.update(filtered[2][i]) / 10;
+                        if(eeg_alpha > 100) { eeg_alpha = 100; }
+                        lslSample_alpha[0] = (float)eeg_alpha * 0.01f;
+                        outlet_alpha->push_sample(lslSample_alpha);
                 
-            }
+                    }
             
-            // send LSL ECG
-            if (ecg_enable)
-            {
-                lslSample_ecg[0] = data_ecg;
-                outlet_ecg->push_sample(lslSample_ecg);
-            }
+                    // send LSL ECG
+                    if (ecg_enable)
+                    {
+                        lslSample_ecg[0] = data_ecg;
+                        outlet_ecg->push_sample(lslSample_ecg);
+                    }
 
-            cout << " Time:" << to_string(tick) <<  
-                    " HR:" << to_string(lslSample_hr[0]) << 
-                    " ECG:" << to_string(data_ecg) << 
-                    " RESP:" << to_string(data_resp)  << 
-                    " EEG:" << to_string(data_eeg) << 
-                    " Alpha:" << to_string(lslSample_alpha[0]) << endl;
+                    cout << " Time:" << to_string(tick) <<  
+                            " HR:" << to_string(lslSample_hr[0]) << 
+                            " ECG:" << to_string(data_ecg) << 
+                            " RESP:" << to_string(data_resp)  << 
+                            " EEG:" << to_string(data_eeg) << 
+                            " Alpha:" << to_string(lslSample_alpha[0]) << endl;
             
-        } while (!keypressed()); // Press Enter to exit.
+                }
+            } while (nFrames == (int) frames.size());
+        }
         
+        ::close(epfd);
+        ::close(sigfd);
+        
+        acq.stop();
         dev.stop();
         
+        BITalino::LinkStats stats = dev.linkStats();
+        cout << "Resyncs:" << stats.resyncs << " Skipped bytes:" << stats.skippedBytes << " Gaps:" << stats.gaps << " Lost frames:" << stats.lostFrames << endl;
+        
+        Acquisition::Stats ringStats = acq.stats();
+        cout << "Frames:" << ringStats.frames << " Ring high-water mark:" << ringStats.highWater << " Overflows:" << ringStats.overflows << endl;
+        
         if (hr_enable)
         {
             delete outlet_hr;
             delete info_hr;
+            delete outlet_rr;
+            delete info_rr;
+            delete outlet_hrv;
+            delete info_hrv;
         }
         if (resp_enable)
         {
@@ -0,0 +1,159 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// BiquadBank against BiquadCascade<float>: each lane of a bank gets its own design, a BiquadCascade<float>
+// with the same design filters the same channel, and the outputs are compared over 20000 samples fed in
+// blocks of 10 (a 100 ms batch at 100 Hz). The banks hold the band-pass designs of main.cpp along with
+// low-pass, high-pass and band-stop designs, at 100 Hz and 1000 Hz, with 2 sections (the paired-section
+// loop) and with 3 sections (the single-section tail).
+// The outputs must be identical, unless the compiler may fuse multiply-adds: they must then stay within
+// the bound given in BiquadBank.h, relative to the peak output of the channel.
+// The test is built once per lane implementation (see CMakeLists.txt). A build for AVX or FMA returns 77
+// (skipped) on a processor without them. Returns 0 when every bank passes.
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "BiquadBank.h"
+
+#if defined(__FP_FAST_FMAF) || defined(__ARM_FEATURE_FMA)
+static const bool fused = true;
+#else
+static const bool fused = false;
+#endif
+
+typedef BiquadCascade<double> Design;
+
+struct Filter
+{
+    Design::Type type;
+    double low, high;
+    int order;
+};
+
+static bool compare(const char *name, double fs, const Filter *filters, int channels, double bound)
+{
+    const double pi = 3.14159265358979323846;
+    const int n = 20000, block = 10;
+
+    BiquadBank bank(channels, Design(filters[0].type, fs, filters[0].low, filters[0].high, filters[0].order));
+    std::vector<BiquadCascade<float> > references;
+    for (int c = 0; c < channels; c++)
+    {
+        const Filter &f = filters[c];
+        if (!bank.setChannel(c, Design(f.type, fs, f.low, f.high, f.order)))
+        {
+            printf("%-26s design of channel %d rejected: FAILED\n", name, c);
+            return false;
+        }
+        references.push_back(BiquadCascade<float>((BiquadCascade<float>::Type) f.type, fs, f.low, f.high, f.order));
+    }
+
+    // 10-bit samples: a slow and a fast sine, different for each channel, and noise
+    srand(7);
+    std::vector<std::vector<short> > x(channels, std::vector<short>(n));
+    for (int c = 0; c < channels; c++)
+        for (int i = 0; i < n; i++)
+            x[c][i] = (short) (512 + 200 * sin(2 * pi * (0.3 + 0.2 * c) * i / fs) + 100 * sin(2 * pi * (9 + 3 * c) * i / fs) + rand() % 60);
+
+    std::vector<std::vector<float> > y(channels, std::vector<float>(block));
+    const short *in[BiquadBank::maxChannels];
+    float *out[BiquadBank::maxChannels];
+    std::vector<double> maxError(channels), peak(channels);
+    long differences = 0;
+    for (int i = 0; i < n; i += block)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            in[c] = &x[c][i];
+            out[c] = &y[c][0];
+        }
+        bank.step(in, out, block);
+        for (int c = 0; c < channels; c++)
+            for (int j = 0; j < block; j++)
+            {
+                const float r = references[c].step(float(x[c][i+j]));
+                if (y[c][j] != r)    differences++;
+                maxError[c] = std::max(maxError[c], fabs((double) y[c][j] - r));
+                peak[c] = std::max(peak[c], fabs((double) r));
+            }
+    }
+
+    double relative = 0;
+    for (int c = 0; c < channels; c++)
+        relative = std::max(relative, maxError[c] / peak[c]);
+    const bool ok = fused ? relative <= bound : differences == 0;
+    if (fused)
+        printf("%-26s %ld different outputs, max error %.2g of the peak (bound %g): %s\n", name, differences, relative,
+               bound, ok ? "OK" : "FAILED");
+    else
+        printf("%-26s %ld different outputs: %s\n", name, differences, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main()
+{
+#if defined(__GNUC__) && defined(__AVX__)
+#if defined(__FMA__)
+    if (!__builtin_cpu_supports("avx") || !__builtin_cpu_supports("fma"))
+#else
+    if (!__builtin_cpu_supports("avx"))
+#endif
+    {
+        printf("no AVX or FMA on this processor, skipped\n");
+        return 77;
+    }
+#endif
+#if defined(BIQUADBANK_NO_SIMD)
+    printf("scalar lanes%s\n", fused ? ", fused multiply-adds" : "");
+#elif defined(__AVX__)
+    printf("AVX lanes%s\n", fused ? ", fused multiply-adds" : "");
+#elif defined(__SSE__) || defined(_M_X64)
+    printf("SSE lanes%s\n", fused ? ", fused multiply-adds" : "");
+#elif defined(__ARM_NEON)
+    printf("NEON lanes%s\n", fused ? ", fused multiply-adds" : "");
+#else
+    printf("scalar lanes%s\n", fused ? ", fused multiply-adds" : "");
+#endif
+
+    // main.cpp: ECG 1-20 Hz, respiration 0.1-1 Hz, EEG 8-12 Hz, default 0.5-40 Hz; then other types
+    // of 2 sections
+    const Filter twoSections[8] = {
+        {Design::BandPass, 1, 20, 2}, {Design::BandPass, 0.1, 1, 2}, {Design::BandPass, 8, 12, 2},
+        {Design::BandPass, 0.5, 40, 2}, {Design::LowPass, 20, 20, 4}, {Design::HighPass, 0.5, 0.5, 4},
+        {Design::BandStop, 45, 48, 2}, {Design::LowPass, 5, 5, 3}};
+    const Filter twoSections1000[8] = {
+        {Design::BandPass, 1, 20, 2}, {Design::BandPass, 0.1, 1, 2}, {Design::BandPass, 8, 12, 2},
+        {Design::BandPass, 0.5, 40, 2}, {Design::LowPass, 40, 40, 4}, {Design::HighPass, 0.5, 0.5, 4},
+        {Design::BandStop, 49, 51, 2}, {Design::LowPass, 100, 100, 3}};
+    const Filter threeSections[6] = {
+        {Design::BandPass, 1, 20, 3}, {Design::BandPass, 0.5, 40, 3}, {Design::BandStop, 40, 45, 3},
+        {Design::LowPass, 20, 20, 6}, {Design::HighPass, 1, 1, 5}, {Design::LowPass, 10, 10, 5}};
+
+    bool ok = true;
+    ok &= compare("2 sections at 100 Hz", 100, twoSections, 8, 1e-4);
+    ok &= compare("2 sections at 1000 Hz", 1000, twoSections1000, 8, 5e-3);
+    ok &= compare("3 sections at 100 Hz", 100, threeSections, 6, 1e-4);
+    ok &= compare("3 sections at 1000 Hz", 1000, threeSections, 6, 5e-3);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// FixedBiquadCascade against the same design filtering in double precision: after the start-up transient,
+// every output must be within one LSB of the rounded double output. The block step() must match the
+// per-sample step() exactly, and full-scale input must saturate instead of wrapping around.
+// Returns 0 when every check passes.
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "FixedBiquadFilter.h"
+
+typedef BiquadCascade<double> Design;
+
+static bool compare(const char *name, const Design &design, double fs)
+{
+    FixedBiquadCascade<short, 10> fixed(design), block(design);
+    Design reference = design;
+    const double pi = 3.14159265358979323846;
+    const int n = 200000;
+
+    srand(5);
+    std::vector<short> x(n), y(n), yBlock(n);
+    double maxError = 0;
+    for (int i = 0; i < n; i++)
+    {
+        x[i] = (short) (512 + 300 * sin(2 * pi * 1.2 * i / fs) + 150 * sin(2 * pi * 10 * i / fs) + rand() % 40);
+        const double r = reference.step((double) x[i]);
+        y[i] = fixed.step(x[i]);
+        if (i > n / 10)    maxError = std::max(maxError, fabs(y[i] - r));
+    }
+    for (int i = 0; i < n; i += 100)
+        block.step(&x[i], &yBlock[i], 100);
+    const bool identical = std::equal(y.begin(), y.end(), yBlock.begin());
+
+    const bool ok = maxError < 1 && identical;
+    printf("%-28s max error %.3f LSB, block %s: %s\n", name, maxError, identical ? "identical" : "DIFFERS", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+    ok &= compare("band-pass 1-20 Hz @100", Design(Design::BandPass, 100, 1, 20, 2), 100);
+    ok &= compare("band-pass 8-12 Hz @100", Design(Design::BandPass, 100, 8, 12, 2), 100);
+    ok &= compare("band-pass 0.5-40 Hz @100", Design(Design::BandPass, 100, 0.5, 40, 2), 100);
+    ok &= compare("band-pass 0.5-40 Hz @1000", Design(Design::BandPass, 1000, 0.5, 40, 2), 1000);
+    ok &= compare("band-pass 0.5-40 Hz @1000 o4", Design(Design::BandPass, 1000, 0.5, 40, 4), 1000);
+    ok &= compare("band-stop 49-51 Hz @1000", Design(Design::BandStop, 1000, 49, 51, 2), 1000);
+
+    // full-scale square wave through a resonant band-pass: the output stays within the range of short
+    // and reaches both ends of it
+    FixedBiquadCascade<short, 16> resonant(Design(Design::BandPass, 1000, 49, 51, 4));
+    short high = 0, low = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        const short y = resonant.step((i / 10) % 2 ? 32767 : -32768);
+        high = std::max(high, y);
+        low = std::min(low, y);
+    }
+    const bool saturated = high == 32767 && low == -32768;
+    printf("saturation: output range [%d, %d]: %s\n", low, high, saturated ? "OK" : "FAILED");
+    ok &= saturated;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// HRVAnalyzer time-domain metrics around ignored intervals: a sequence of RR intervals with an interval out
+// of the 0.25-2.5 s range in the middle, and one at the start, must give the RMSSD and pNN50 of the
+// successive differences of the valid intervals that follow each other, the interval after an ignored one
+// not being differenced against the interval before it. Returns 0 when every case passes.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "HRVAnalyzer.h"
+
+// feeds the intervals (s), and checks the number of beats, RMSSD and pNN50 (ms, %)
+static bool check(const char *name, const double *rr, int n, int beats, double rmssd, double pnn50)
+{
+    HRVAnalyzer hrv;
+    double time = 0;
+    for (int i = 0; i < n; i++)
+    {
+        time += rr[i];
+        hrv.update(rr[i], time);
+    }
+    const bool ok = hrv.getBeats() == beats && fabs(hrv.getRMSSD() - rmssd) < 1e-9 && fabs(hrv.getPNN50() - pnn50) < 1e-9;
+    printf("%-30s %d beats, RMSSD %.3f ms (%.3f), pNN50 %.1f%% (%.1f): %s\n", name, hrv.getBeats(), hrv.getRMSSD(), rmssd,
+           hrv.getPNN50(), pnn50, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main()
+{
+    // differences 20, -30 and 60 ms
+    const double valid[4] = {0.8, 0.82, 0.79, 0.85};
+    // differences 20, then 10 ms after the gap (not 380 ms against 0.82 s)
+    const double gap[5] = {0.8, 0.82, 3.0, 1.2, 1.21};
+    // two ignored intervals in a row, then a short one
+    const double gaps[6] = {0.8, 0.82, 0.1, 3.0, 1.2, 1.21};
+    // ignored first interval: 0.8 s has no predecessor
+    const double first[3] = {0.2, 0.8, 0.86};
+
+    bool ok = true;
+    ok &= check("valid intervals", valid, 4, 4, sqrt((400 + 900 + 3600) / 3.0), 100 / 3.0);
+    ok &= check("ignored interval", gap, 5, 4, sqrt((400 + 100) / 2.0), 0);
+    ok &= check("two ignored intervals", gaps, 6, 4, sqrt((400 + 100) / 2.0), 0);
+    ok &= check("ignored first interval", first, 3, 2, 60, 100);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// QRSDetector on a synthetic ECG band-passed at 1-20 Hz, at 100, 250, 500 and 1000 Hz. The band-pass starts
+// from rest on a signal centred on 512 counts, so that its start-up transient can be larger than the QRS
+// complexes. Beats after the learning period must be found within 100 ms, with at most 1% missed and 1%
+// false detections:
+//  - QRS amplitudes of 300 and 60 counts, at 60, 120 and 180 BPM;
+//  - an amplitude falling from 300 to 40 counts after 100 s, from which the detector must recover.
+// Returns 0 when every case passes.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "BiquadFilter.h"
+#include "QRSDetector.h"
+
+static const double pi = 3.14159265358979323846;
+
+static double gauss(double t, double mu, double sigma) { return exp(-(t - mu) * (t - mu) / (2 * sigma * sigma)); }
+
+// ECG of the given length (s) in ADC counts, with RR variability, baseline wander and noise,
+// whose QRS amplitude is amplitude until drop (s) and dropped after it; beats gets the R peak times
+static void ecg(double fs, double length, double bpm, double amplitude, double drop, double dropped,
+                std::vector<double> &x, std::vector<double> &beats)
+{
+    srand(11);
+    beats.clear();
+    for (double t = 0.4; t < length; t += 60 / bpm * (1 + 0.08 * ((rand() % 200) / 100.0 - 1)))
+        beats.push_back(t);
+
+    x.assign((size_t) (fs * length), 0);
+    size_t first = 0;
+    for (size_t k = 0; k < x.size(); k++)
+    {
+        const double t = k / fs;
+        double e = 0;
+        while (first < beats.size() && beats[first] < t - 0.6)    first++;
+        for (size_t b = first; b < beats.size() && beats[b] < t + 0.6; b++)
+        {
+            const double tb = t - beats[b];
+            const double scale = 1 + 0.3 * sin(2 * pi * beats[b] / 13);
+            e += scale * (0.12 * gauss(tb, -0.2, 0.025) - 0.1 * gauss(tb, -0.03, 0.01) + gauss(tb, 0, 0.012)
+                          - 0.25 * gauss(tb, 0.03, 0.01) + 0.35 * gauss(tb, 0.25, 0.04));
+        }
+        x[k] = 512 + (t < drop ? amplitude : dropped) * e + 40 * sin(2 * pi * 0.25 * t) + 5 * ((rand() % 2001) / 1000.0 - 1);
+    }
+}
+
+// runs the detector, and checks the beats from from (s)
+static bool run(const char *name, double fs, double bpm, double amplitude, double drop, double dropped, double from)
+{
+    std::vector<double> x, beats;
+    ecg(fs, 300, bpm, amplitude, drop, dropped, x, beats);
+
+    BiquadCascade<double> bandpass(BiquadCascade<double>::BandPass, fs, 1, 20, 2);
+    bandpass.step(&x[0], x.size());
+    QRSDetector detector(fs);
+    std::vector<double> detections;
+    for (size_t i = 0; i < x.size(); i++)
+        if (detector.update(x[i]))    detections.push_back(detector.getPeakPosition() / fs);
+
+    int truth = 0, found = 0, falses = 0;
+    std::vector<bool> matched(detections.size(), false);
+    for (size_t b = 0; b < beats.size(); b++)
+    {
+        if (beats[b] < from)    continue;
+        truth++;
+        for (size_t k = 0; k < detections.size(); k++)
+            if (!matched[k] && fabs(detections[k] - beats[b]) < 0.1)
+            {
+                matched[k] = true;
+                found++;
+                break;
+            }
+    }
+    for (size_t k = 0; k < detections.size(); k++)
+        if (!matched[k] && detections[k] > from)    falses++;
+
+    const bool ok = (truth - found) <= truth / 100 && falses <= truth / 100;
+    printf("%-22s %4.0f Hz %3.0f BPM: %d beats, %d missed, %d false: %s\n", name, fs, bpm, truth, truth - found, falses, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+    const double rates[] = {100, 250, 500, 1000};
+    for (int r = 0; r < 4; r++)
+        for (double bpm = 60; bpm <= 180; bpm += 60)
+        {
+            ok &= run("amplitude 300", rates[r], bpm, 300, 1e9, 0, 3.5);
+            ok &= run("amplitude 60", rates[r], bpm, 60, 1e9, 0, 3.5);
+            ok &= run("amplitude 300 to 40", rates[r], bpm, 300, 100, 40, 110);
+        }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Stress test of Circular_Buffer_SPSC: a producer thread writes a sequence of numbers in chunks of random
+// length, a consumer thread reads it in chunks of random length, and every value must come out in order,
+// once, for several ring sizes. Returns 0 when every run passes.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+#include "circular_buffer.h"
+
+template<uint16_t N>
+static bool stress(uint64_t total)
+{
+    static Circular_Buffer_SPSC<uint64_t, N> ring;
+
+    std::thread producer([&]
+    {
+        uint64_t buffer[300];
+        uint64_t next = 0;
+        unsigned seed = 1;
+        while (next < total)
+        {
+            int length = rand_r(&seed) % 300 + 1;
+            if (length > (int) (total - next))    length = (int) (total - next);
+            for (int i = 0; i < length; i++)    buffer[i] = next + i;
+            const int written = ring.write(buffer, length);
+            if (!written)    std::this_thread::yield();
+            next += written;
+        }
+    });
+
+    uint64_t buffer[300];
+    uint64_t expected = 0, errors = 0;
+    unsigned seed = 2;
+    while (expected < total)
+    {
+        const int n = ring.read(buffer, rand_r(&seed) % 300 + 1);
+        if (!n)    std::this_thread::yield();
+        for (int i = 0; i < n; i++)
+            if (buffer[i] != expected++)    errors++;
+    }
+    producer.join();
+
+    const bool ok = !errors && ring.empty();
+    printf("ring of %5u: %llu values, %llu out of order, %s\n", N, (unsigned long long) total,
+           (unsigned long long) errors, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main()
+{
+    bool ok = true;
+    ok &= stress<4>(1000000);
+    ok &= stress<16>(2000000);
+    ok &= stress<1024>(5000000);
+    ok &= stress<32768>(5000000);
+    return ok ? 0 : 1;
+}
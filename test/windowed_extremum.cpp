@@ -0,0 +1,121 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Windowed_Extremum against the sorting max() and min() of a plain Circular_Buffer: both buffers go through
+// the same random sequence of push_back, pop_front, push_front, pop_back, sorts, bulk writes and reads and
+// clears, and must report the same size, max() and min() after every operation. Returns 0 when they do.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "circular_buffer.h"
+
+template<typename T, uint16_t N>
+static bool check(unsigned seed)
+{
+    static Circular_Buffer<T, N> plain;
+    static Circular_Buffer<T, N, 0, Windowed_Extremum> policy;
+    srand(seed);
+
+    for (int i = 0; i < 200000; i++)
+    {
+        const int op = rand() % 100;
+        const T value = (T) (rand() % 2000 - 1000) / (T) (rand() % 3 + 1);
+        T buffer[5] = {value, value + 1, value - 3, value * 2, value};
+
+        if (op < 70)
+        {
+            plain.push_back(value);
+            policy.push_back(value);
+        }
+        else if (op < 85)
+        {
+            if (plain.size())
+            {
+                plain.pop_front();
+                policy.pop_front();
+            }
+        }
+        else if (op < 90)
+        {
+            if (plain.size() && plain.size() < N)
+            {
+                plain.push_front(value);
+                policy.push_front(value);
+            }
+        }
+        else if (op < 94)
+        {
+            if (plain.size())
+            {
+                plain.pop_back();
+                policy.pop_back();
+            }
+        }
+        else if (op < 95)
+        {
+            plain.sort_ascending();
+            policy.sort_ascending();
+        }
+        else if (op < 96)
+        {
+            plain.sort_descending();
+            policy.sort_descending();
+        }
+        else if (op < 97)
+        {
+            for (int k = 0; k < 5; k++)    plain.write(buffer[k]);
+            policy.write(buffer, 5);
+        }
+        else if (op < 98)
+        {
+            if (plain.size() >= 5)
+            {
+                plain.readBytes(buffer, 5);
+                policy.readBytes(buffer, 5);
+            }
+        }
+        else if (rand() % 50 == 0)
+        {
+            plain.clear();
+            policy.clear();
+        }
+
+        if (plain.size() != policy.size() || plain.max() != policy.max() || plain.min() != policy.min())
+        {
+            printf("window of %u: mismatch at operation %d (%d): max %g/%g, min %g/%g\n", N, i, op,
+                   (double) plain.max(), (double) policy.max(), (double) plain.min(), (double) policy.min());
+            return false;
+        }
+    }
+    printf("window of %u: OK\n", N);
+    return true;
+}
+
+int main()
+{
+    bool ok = true;
+    ok &= check<float, 4>(5);
+    ok &= check<long, 8>(1);
+    ok &= check<long, 32>(2);
+    ok &= check<double, 64>(3);
+    ok &= check<int, 256>(4);
+    return ok ? 0 : 1;
+}
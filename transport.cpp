@@ -0,0 +1,352 @@
+/*
+    LSL_Bridge
+    Copyright (C) 2020  Creact
+    Copyright (C) 2020  Ullo
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/*****************************************************************************/
+
+#ifndef _WIN32 // Linux or Mac OS
+
+#include <algorithm>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#ifdef HASBLUETOOTH  // Linux only
+
+#include <sys/socket.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/rfcomm.h>
+
+#endif // HASBLUETOOTH
+
+#ifdef __linux__
+
+#include <sys/timerfd.h>
+
+#endif // __linux__
+
+#include "bitalino.h"
+#include "transport.h"
+
+/*****************************************************************************/
+
+Transport* Transport::open(const char *address)
+{
+   if (memcmp(address, "/dev/", 5) == 0)
+      return new SerialTransport(address);
+
+#ifdef __linux__
+   if (memcmp(address, "replay:", 7) == 0)
+      return new ReplayTransport(address+7);
+#endif
+
+#ifdef HASBLUETOOTH
+   return new RfcommTransport(address);
+#else
+   throw BITalino::Exception(BITalino::Exception::PORT_COULD_NOT_BE_OPENED);
+#endif
+}
+
+/*****************************************************************************/
+
+FdTransport::~FdTransport()
+{
+   if (handle >= 0)  ::close(handle);
+}
+
+/*****************************************************************************/
+
+int FdTransport::read(void *data, int maxbyttoread)
+{
+   while (1)
+   {
+      const ssize_t ret = ::read(handle, data, maxbyttoread);
+      if (ret > 0)   return (int) ret;
+
+      if (ret < 0 && errno == EINTR)   continue;
+      if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))   return 0;   // no data available yet
+
+      throw BITalino::Exception(BITalino::Exception::CONTACTING_DEVICE);   // connection closed or lost
+   }
+}
+
+/*****************************************************************************/
+
+void FdTransport::write(const void *data, int nbyttowrite)
+{
+   for(int n = 0; n < nbyttowrite;)
+   {
+      const ssize_t ret = ::write(handle, (const char *) data+n, nbyttowrite-n);
+      if (ret > 0)
+      {
+         n += ret;
+         continue;
+      }
+
+      if (ret < 0 && errno == EINTR)   continue;
+      if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      {  // output buffer is full: wait until the device accepts more data
+         pollfd pfd;
+         pfd.fd = handle;
+         pfd.events = POLLOUT;
+         if (poll(&pfd, 1, 5000) > 0)   continue;
+      }
+
+      throw BITalino::Exception(BITalino::Exception::CONTACTING_DEVICE);
+   }
+}
+
+/*****************************************************************************/
+
+SerialTransport::SerialTransport(const char *path)
+{
+   handle = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+   if (handle < 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_COULD_NOT_BE_OPENED);
+
+   termios term;
+   if (tcgetattr(handle, &term) != 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+
+   cfmakeraw(&term);
+   term.c_oflag &= ~(OPOST);
+
+   term.c_cc[VMIN] = 1;
+   term.c_cc[VTIME] = 1;
+
+   term.c_iflag &= ~(INPCK | PARMRK | ISTRIP | IGNCR | ICRNL | INLCR | IXON | IXOFF | IMAXBEL); // no flow control
+   term.c_iflag |= (IGNPAR | IGNBRK);
+
+   term.c_cflag &= ~(CRTSCTS | PARENB | CSTOPB | CSIZE); // no parity, 1 stop bit
+   term.c_cflag |= (CLOCAL | CREAD | CS8);    // raw mode, 8 bits
+
+   term.c_lflag &= ~(ICANON | ECHO | ECHOE | ECHOPRT | ECHOK | ECHOKE | ECHONL | ECHOCTL | ISIG | IEXTEN | TOSTOP);  // raw mode
+
+   if (cfsetspeed(&term, B115200) != 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+
+   if (tcsetattr(handle, TCSANOW, &term) != 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+}
+
+/*****************************************************************************/
+
+#ifdef HASBLUETOOTH
+
+RfcommTransport::RfcommTransport(const char *macAddress)
+{
+   sockaddr_rc so_bt;
+   so_bt.rc_family = AF_BLUETOOTH;
+   if (str2ba(macAddress, &so_bt.rc_bdaddr) < 0)
+      throw BITalino::Exception(BITalino::Exception::INVALID_ADDRESS);
+
+   so_bt.rc_channel = 1;
+
+   handle = socket(AF_BLUETOOTH, SOCK_STREAM, BTPROTO_RFCOMM);
+   if (handle < 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+
+   if (connect(handle, (const sockaddr*)&so_bt, sizeof so_bt) != 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_COULD_NOT_BE_OPENED);
+
+   // connect in blocking mode, then switch to non-blocking I/O
+   const int flags = fcntl(handle, F_GETFL);
+   if (flags == -1 || fcntl(handle, F_SETFL, flags | O_NONBLOCK) == -1)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+}
+
+#endif // HASBLUETOOTH
+
+/*****************************************************************************/
+
+PtyTransport::PtyTransport()
+{
+   handle = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+   if (handle < 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_COULD_NOT_BE_OPENED);
+
+   if (grantpt(handle) != 0 || unlockpt(handle) != 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+
+   const char *name = ptsname(handle);
+   if (name == NULL)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+
+   slave = name;
+
+   termios term;
+   if (tcgetattr(handle, &term) != 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+
+   cfmakeraw(&term);
+   if (tcsetattr(handle, TCSANOW, &term) != 0)
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+}
+
+/*****************************************************************************/
+
+#ifdef __linux__
+
+ReplayTransport::ReplayTransport(const char *path) :
+   timer(-1), streaming(false), pwmValue(false), samplingRate(1000), frameSize(8), framesSent(0)
+{
+   file = fopen(path, "rb");
+   if (file == NULL)
+      throw BITalino::Exception(BITalino::Exception::PORT_COULD_NOT_BE_OPENED);
+
+   timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+   if (timer < 0)
+   {
+      fclose(file);
+      throw BITalino::Exception(BITalino::Exception::PORT_INITIALIZATION);
+   }
+}
+
+/*****************************************************************************/
+
+ReplayTransport::~ReplayTransport()
+{
+   ::close(timer);
+   fclose(file);
+}
+
+/*****************************************************************************/
+
+int ReplayTransport::read(void *data, int maxbyttoread)
+{
+   unsigned long long expirations;
+   while (::read(timer, &expirations, sizeof expirations) > 0);   // acknowledge the timer
+
+   char *ptr = (char *) data;
+   int n = 0;
+
+   // command reply first
+   while (!reply.empty() && n < maxbyttoread)
+   {
+      const int len = std::min((int) reply.size(), maxbyttoread-n);
+      memcpy(ptr+n, reply.data(), len);
+      reply.erase(0, len);
+      n += len;
+   }
+
+   if (streaming)
+   {
+      // frames due since the start command at the requested sampling rate
+      timespec now;
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      const double elapsed = (now.tv_sec - started.tv_sec) + (now.tv_nsec - started.tv_nsec) * 1e-9;
+
+      long long nFrames = (long long)(elapsed * samplingRate) + 1 - framesSent;
+      if (nFrames > (maxbyttoread-n) / frameSize)   nFrames = (maxbyttoread-n) / frameSize;
+
+      for(int len = int(nFrames * frameSize); len > 0;)
+      {
+         const size_t ret = fread(ptr+n, 1, len, file);
+         if (ret == 0)
+         {
+            if (ftell(file) == 0)   throw BITalino::Exception(BITalino::Exception::CONTACTING_DEVICE);   // empty file
+            rewind(file);    // loop the recording
+            continue;
+         }
+         n += ret;
+         len -= ret;
+      }
+
+      framesSent += nFrames;
+   }
+
+   arm();
+   return n;
+}
+
+/*****************************************************************************/
+
+void ReplayTransport::write(const void *data, int nbyttowrite)
+{
+   for(int i = 0; i < nbyttowrite; i++)
+      command(((const unsigned char *) data)[i]);
+
+   arm();
+}
+
+/*****************************************************************************/
+
+void ReplayTransport::command(unsigned char cmd)
+{
+   if (pwmValue)
+   {  // byte following the PWM command is the output value
+      pwmValue = false;
+      return;
+   }
+
+   if (cmd == 0x07)    // 0  0  0  0  0  1  1  1 - Send version string
+   {
+      streaming = false;
+      reply = "BITalino_v5.2\n";
+   }
+   else if (cmd == 0x00)   // 0  0  0  0  0  0  0  0 - Go to idle mode
+      streaming = false;
+   else if (cmd == 0xA3)   // 1  0  1  0  0  0  1  1 - Set analog output (1 byte follows: 0..255)
+      pwmValue = true;
+   else if (!streaming && (cmd & 0x3F) == 0x03)    // <Fs>  0  0  0  0  1  1 - Set sampling rate
+   {
+      static const int rates[4] = {1, 10, 100, 1000};
+      samplingRate = rates[cmd >> 6];
+   }
+   else if (!streaming && ((cmd & 0x03) == 0x01 || (cmd & 0x03) == 0x02))    // Start live or simulated mode
+   {
+      int nChannels = 0;
+      for(int i = 0; i < 6; i++)
+         if (cmd & (0x04 << i))   nChannels++;
+
+      frameSize = (nChannels >= 3 && nChannels <= 5) ? nChannels + 3 : nChannels + 2;
+      streaming = true;
+      framesSent = 0;
+      clock_gettime(CLOCK_MONOTONIC, &started);
+   }
+   // other commands (battery threshold, digital outputs, state) are accepted without effect
+}
+
+/*****************************************************************************/
+
+void ReplayTransport::arm(void)
+{
+   itimerspec spec;
+   memset(&spec, 0, sizeof spec);
+
+   if (!reply.empty())
+      spec.it_value.tv_nsec = 1;    // reply is ready now
+   else if (streaming)
+   {  // wake up every 10 ms, or at each frame for lower sampling rates
+      const long period = (samplingRate >= 100) ? 10000000L : 1000000000L / samplingRate;
+      spec.it_value.tv_sec = spec.it_interval.tv_sec = period / 1000000000L;
+      spec.it_value.tv_nsec = spec.it_interval.tv_nsec = period % 1000000000L;
+   }
+
+   timerfd_settime(timer, 0, &spec, NULL);
+}
+
+#endif // __linux__
+
+#endif // Linux or Mac OS
+
+/*****************************************************************************/